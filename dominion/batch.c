@@ -0,0 +1,295 @@
+/* 	Batch engine for treasure-only games
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "batch.h"
+
+//bigmoney in strategy.c: Province, Duchy once Provinces are gone (which
+//ends the game anyway), Gold, Silver
+static const struct batchBot bigMoney = {"bigmoney", 4,
+  {{province, 1000}, {duchy, 0}, {gold, 1000}, {silver, 1000}}};
+
+
+static unsigned int nextRandom(unsigned long long *x) {
+  unsigned long long z = (*x += 0x9E3779B97F4A7C15ULL);
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return (unsigned int) ((z ^ (z >> 31)) >> 32);
+}
+
+//the starting state of the game with this seed.  It depends on the
+//seed alone, so a game plays the same whichever batch it is run in
+static unsigned long long streamFor(long seed) {
+  unsigned long long z = (unsigned long long) seed;
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+//one card off player's deck in every game, the discard shuffled back
+//in first where the deck is empty.  total holds each deck's size
+static void drawOne(struct batchGames *b, int player, int *total) {
+  int *pick = b->scratch[1];
+  int *d, *s, *h;
+  int numGames = b->numGames;
+  int g, c, n, take;
+
+  for (g = 0; g < numGames; g++)
+    pick[g] = total[g] == 0;
+  for (c = 0; c < BATCH_CARDS; c++)
+    {
+      d = b->deck[player][c];
+      s = b->discard[player][c];
+      for (g = 0; g < numGames; g++)
+	{
+	  n = pick[g] ? s[g] : 0;
+	  d[g] += n;
+	  s[g] -= n;
+	  total[g] += n;
+	}
+    }
+
+  //a uniform position in the deck, found by walking down the counts;
+  //an empty deck and discard draw nothing
+  for (g = 0; g < numGames; g++)
+    pick[g] = (int) (((unsigned long long) nextRandom(&b->rng[g]) * total[g]) >> 32);
+
+  for (c = 0; c < BATCH_CARDS; c++)
+    {
+      d = b->deck[player][c];
+      h = b->hand[player][c];
+      for (g = 0; g < numGames; g++)
+	{
+	  n = d[g];
+	  take = pick[g] >= 0 && pick[g] < n;
+	  pick[g] -= n;
+	  d[g] = n - take;
+	  h[g] += take;
+	}
+    }
+
+  for (g = 0; g < numGames; g++)
+    total[g] -= total[g] > 0;
+}
+
+//the hand (with what was bought) to the discard and five new cards
+static void cleanUp(struct batchGames *b, int player) {
+  int *total = b->scratch[0];
+  int *d, *s, *h;
+  int numGames = b->numGames;
+  int g, c, i;
+
+  memset(total, 0, numGames * sizeof(int));
+  for (c = 0; c < BATCH_CARDS; c++)
+    {
+      d = b->deck[player][c];
+      s = b->discard[player][c];
+      h = b->hand[player][c];
+      for (g = 0; g < numGames; g++)
+	{
+	  s[g] += h[g];
+	  h[g] = 0;
+	  total[g] += d[g];
+	}
+    }
+  for (i = 0; i < 5; i++)
+    drawOne(b, player, total);
+}
+
+int initBatch(struct batchGames *b, int numGames, int numPlayers, long seed) {
+  int arrays = BATCH_CARDS * (1 + 3 * MAX_PLAYERS) + 5;
+  int *next;
+  int g, c, p, victory;
+
+  memset(b, 0, sizeof(struct batchGames));
+  if (numGames < 1 || numPlayers < 2 || numPlayers > MAX_PLAYERS)
+    return -1;
+
+  //the 64-bit states go first so they stay aligned
+  b->block = calloc(numGames, sizeof(unsigned long long) + arrays * sizeof(int));
+  if (b->block == NULL)
+    return -1;
+
+  b->numGames = numGames;
+  b->numPlayers = numPlayers;
+  b->rng = b->block;
+  next = (int *) (b->rng + numGames);
+  for (c = 0; c < BATCH_CARDS; c++)
+    {
+      b->supply[c] = next;
+      next += numGames;
+      for (p = 0; p < MAX_PLAYERS; p++)
+	{
+	  b->deck[p][c] = next;
+	  b->hand[p][c] = next + numGames;
+	  b->discard[p][c] = next + 2 * numGames;
+	  next += 3 * numGames;
+	}
+    }
+  b->coins = next;
+  b->buy = next + numGames;
+  b->turns = next + 2 * numGames;
+  b->scratch[0] = next + 3 * numGames;
+  b->scratch[1] = next + 4 * numGames;
+
+  //the same base supply and starting decks as initializeGame
+  victory = numPlayers == 2 ? 8 : 12;
+  for (g = 0; g < numGames; g++)
+    {
+      b->rng[g] = streamFor(seed + g);
+      b->supply[curse][g] = 10 * (numPlayers - 1);
+      b->supply[estate][g] = victory;
+      b->supply[duchy][g] = victory;
+      b->supply[province][g] = victory;
+      b->supply[copper][g] = 60 - 7 * numPlayers;
+      b->supply[silver][g] = 40;
+      b->supply[gold][g] = 30;
+      for (p = 0; p < numPlayers; p++)
+	{
+	  b->deck[p][copper][g] = 7;
+	  b->deck[p][estate][g] = 3;
+	}
+    }
+  for (p = 0; p < numPlayers; p++)
+    cleanUp(b, p);
+
+  return 0;
+}
+
+void freeBatch(struct batchGames *b) {
+  free(b->block);
+  memset(b, 0, sizeof(struct batchGames));
+}
+
+int playBatchTurn(struct batchGames *b, const struct batchBot *bot) {
+  int player = b->whoseTurn;
+  int *coins = b->coins;
+  int *buy = b->buy;
+  int *turns = b->turns;
+  int *h1 = b->hand[player][copper];
+  int *h2 = b->hand[player][silver];
+  int *h3 = b->hand[player][gold];
+  int *empty = b->scratch[0];
+  int *supply, *provinces, *s;
+  int numGames = b->numGames;
+  int g, c, i, cost, limit, ok, running;
+
+  //treasure
+  for (g = 0; g < numGames; g++)
+    coins[g] = h1[g] + 2 * h2[g] + 3 * h3[g];
+
+  //buy: the first rule that fits, in games still going
+  for (g = 0; g < numGames; g++)
+    buy[g] = -1;
+  provinces = b->supply[province];
+  for (i = 0; i < bot->numRules; i++)
+    {
+      c = bot->rule[i].card;
+      if (c < curse || c > gold)
+	continue;
+      cost = getCost(c);
+      limit = bot->rule[i].provincesAtMost;
+      supply = b->supply[c];
+      for (g = 0; g < numGames; g++)
+	{
+	  ok = buy[g] < 0 && turns[g] == 0 && coins[g] >= cost && supply[g] > 0 &&
+	    provinces[g] <= limit;
+	  buy[g] = ok ? c : buy[g];
+	}
+    }
+  for (c = 0; c < BATCH_CARDS; c++)
+    {
+      supply = b->supply[c];
+      s = b->discard[player][c];
+      for (g = 0; g < numGames; g++)
+	{
+	  ok = buy[g] == c;
+	  supply[g] -= ok;
+	  s[g] += ok;
+	}
+    }
+
+  cleanUp(b, player);
+
+  //game over, as isGameOver has it
+  memset(empty, 0, numGames * sizeof(int));
+  for (c = 0; c < BATCH_CARDS; c++)
+    {
+      supply = b->supply[c];
+      for (g = 0; g < numGames; g++)
+	empty[g] += supply[g] == 0;
+    }
+  running = 0;
+  for (g = 0; g < numGames; g++)
+    {
+      ok = turns[g] == 0 && (provinces[g] == 0 || empty[g] >= 3);
+      turns[g] = ok ? b->turn + 1 : turns[g];
+      running += turns[g] == 0;
+    }
+
+  b->turn++;
+  b->whoseTurn = (player + 1) % b->numPlayers;
+  return running;
+}
+
+int playBatch(struct batchGames *b, const struct batchBot *bots[], int maxTurns) {
+  int running = b->numGames;
+
+  while (running > 0 && b->turn < maxTurns)
+    running = playBatchTurn(b, bots[b->whoseTurn]);
+  return running;
+}
+
+int batchScore(struct batchGames *b, int game, int player) {
+  int n[BATCH_CARDS];
+  int c;
+
+  if (game < 0 || game >= b->numGames || player < 0 || player >= b->numPlayers)
+    return -9999;
+
+  for (c = 0; c < BATCH_CARDS; c++)
+    n[c] = b->deck[player][c][game] + b->hand[player][c][game] + b->discard[player][c][game];
+  return n[estate] + 3 * n[duchy] + 6 * n[province] - n[curse];
+}
+
+int batchWinners(struct batchGames *b, int game, int players[MAX_PLAYERS]) {
+  int current, high;
+  int i;
+
+  if (game < 0 || game >= b->numGames)
+    return -1;
+
+  for (i = 0; i < MAX_PLAYERS; i++)
+    players[i] = i < b->numPlayers ? batchScore(b, game, i) : -9999;
+
+  //getWinners gives a tie to the players still to play this round,
+  //counted from the turn after the last one
+  current = b->turns[game] > 0 ? b->turns[game] % b->numPlayers : b->whoseTurn;
+  high = players[0];
+  for (i = 1; i < MAX_PLAYERS; i++)
+    if (players[i] > high)
+      high = players[i];
+  for (i = 0; i < MAX_PLAYERS; i++)
+    if (players[i] == high && i > current)
+      players[i]++;
+
+  high = players[0];
+  for (i = 1; i < MAX_PLAYERS; i++)
+    if (players[i] > high)
+      high = players[i];
+  for (i = 0; i < MAX_PLAYERS; i++)
+    players[i] = players[i] == high;
+
+  return 0;
+}
+
+const struct batchBot *findBatchBot(const char *name) {
+  if (strcmp(name, bigMoney.name) == 0)
+    return &bigMoney;
+  return NULL;
+}
@@ -0,0 +1,81 @@
+/* 	Batch engine for treasure-only games
+
+	Plays many games at once in lockstep, for bots that only ever buy
+	treasure, victory cards and curses.  Each pile is kept as a count
+	of each card rather than a list, and each count is an array over
+	the games (structure of arrays), so every step of a turn (counting
+	coins, choosing the buy, cleaning up and drawing) is one pass over
+	the games with no branches that depend on a game.  With no actions
+	in play only which cards are in a deck matters, not their order, so
+	drawing picks uniformly from the deck's counts, which is the same
+	as drawing the top card of a shuffled deck.
+
+	Results agree with the full engine in distribution but not game by
+	game, since the random numbers are used differently.
+*/
+
+#ifndef _BATCH_H
+#define _BATCH_H
+
+#include "dominion.h"
+
+#define BATCH_CARDS (gold + 1)   /* curse .. gold */
+#define BATCH_MAX_RULES 16
+
+struct batchRule {
+  int card;             /* curse .. gold */
+  int provincesAtMost;  /* only while the Province pile is no bigger */
+};
+
+/* A buy rule list: each turn the first card that is affordable and
+   still in supply is bought, and nothing if none is */
+struct batchBot {
+  const char *name;
+  int numRules;
+  struct batchRule rule[BATCH_MAX_RULES];
+};
+
+struct batchGames {
+  int numGames;
+  int numPlayers;
+  int whoseTurn;                        /* the same in every game */
+  int turn;                             /* turns played so far */
+  unsigned long long *rng;              /* [game], SplitMix state */
+  int *supply[BATCH_CARDS];             /* [card][game] */
+  int *deck[MAX_PLAYERS][BATCH_CARDS];  /* [player][card][game] */
+  int *hand[MAX_PLAYERS][BATCH_CARDS];
+  int *discard[MAX_PLAYERS][BATCH_CARDS];
+  int *coins;                           /* [game], this turn */
+  int *buy;                             /* [game], card bought this turn or -1 */
+  int *turns;                           /* [game], turns the game took, 0 while it goes on */
+  int *scratch[2];                      /* [game], for the kernels */
+  void *block;                          /* one allocation holding all the arrays */
+};
+
+int initBatch(struct batchGames *b, int numGames, int numPlayers, long seed);
+/* numGames games with the base supply, each player holding 7 Coppers
+   and 3 Estates with a hand of 5 drawn.  Game g plays seed + g, and its
+   random stream comes from that seed alone, so a seed gives the same
+   game however a run is split into batches.  -1 if the counts are out of
+   range or there is no memory */
+
+void freeBatch(struct batchGames *b);
+
+int playBatchTurn(struct batchGames *b, const struct batchBot *bot);
+/* Play whoseTurn's turn with bot in every game still going, and return
+   how many are still going after it */
+
+int playBatch(struct batchGames *b, const struct batchBot *bots[], int maxTurns);
+/* Play turns, bots[p] for player p, until every game is over or maxTurns
+   turns are played.  Returns how many games are unfinished */
+
+int batchScore(struct batchGames *b, int game, int player);
+
+int batchWinners(struct batchGames *b, int game, int players[MAX_PLAYERS]);
+/* getWinners for one game */
+
+const struct batchBot *findBatchBot(const char *name);
+/* The batch bot that buys like the strategy of that name, NULL if that
+   strategy is not treasure-only.  There is one for bigmoney */
+
+#endif
@@ -0,0 +1,483 @@
+/* Micro-benchmarks for the engine's hot functions
+
+   Times shuffle, drawCard, updateCoins, scoreFor, isGameOver, endTurn,
+   copyGameState, every card's cardEffect and whole games, and prints
+   one tab-separated line per benchmark:
+
+     benchmark  iterations  ns_per_op  ops_per_sec  allocs_per_op
+
+   For the game benchmarks an op is one game, so ops_per_sec is games
+   a second.  Each benchmark is run until it takes the time given, then
+   twice more at that count, and the fastest of the three is kept.
+
+   ./bench [<filter>] [seconds=<s>] [base=<file>]
+
+   filter runs only the benchmarks whose names contain it.  base reads
+   the output of an earlier run (another commit, say) and adds its
+   ns_per_op and the change from it as two more columns.
+
+   The cardEffect rows include restoring the state with copyGameState
+   before every play; the copyGameState row is that cost on its own.
+   Allocations are counted through glibc's malloc and are -1 elsewhere.
+*/
+
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "interface.h"
+#include "strategy.h"
+#include "batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#define MAX_BENCHMARKS 64
+#define MAX_NAME 64
+#define MAX_TURNS 1000
+#define BATCH_GAMES 4096
+
+struct benchmark {
+  char name[MAX_NAME];
+  void (*run)(long n, int arg);
+  int arg;
+};
+
+struct baseline {
+  char name[MAX_NAME];
+  double ns;
+};
+
+static struct benchmark benchmarks[MAX_BENCHMARKS];
+static int numBenchmarks = 0;
+
+static struct baseline base[MAX_BENCHMARKS];
+static int numBase = 0;
+
+//the kingdom the engine benchmarks play, with Smithy and Village for
+//fillDeck and the card effectChoices gains; the last pile is swapped for
+//the card whose effect is timed
+static int kingdom[10] = {smithy, village, adventurer, council_room, feast, gardens,
+			  mine, remodel, baron, great_hall};
+
+//simulate's kingdom, for the game benchmarks
+static int gameKingdom[10] = {adventurer, gardens, embargo, village, minion, mine, cutpurse,
+			      sea_hag, tribute, smithy};
+
+//kept so the calls being timed are not optimized away
+static volatile int sink;
+
+static struct timespec started;
+static double elapsed;      //ns between startTimer and stopTimer
+static long allocsAtStart;
+static long allocs;
+
+static struct gameState G;
+static struct gameState T;
+
+//the calls that leave the state alone go through these, so the compiler
+//cannot see that and do the work once for the whole loop
+static int (*volatile updateCoinsCall)(int player, struct gameState *state, int bonus) = updateCoins;
+static int (*volatile scoreForCall)(int player, struct gameState *state) = scoreFor;
+static int (*volatile isGameOverCall)(struct gameState *state) = isGameOver;
+
+
+//allocation counting: the engine's malloc/calloc/realloc calls come
+//here on their way to glibc's
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void __libc_free(void *p);
+
+static long allocCount = 0;
+
+void *malloc(size_t size) {
+  allocCount++;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+  allocCount++;
+  return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size) {
+  allocCount++;
+  return __libc_realloc(p, size);
+}
+
+void free(void *p) {
+  __libc_free(p);
+}
+#else
+static long allocCount = -1;
+#endif
+
+static void startTimer(void) {
+  allocsAtStart = allocCount;
+  clock_gettime(CLOCK_MONOTONIC, &started);
+}
+
+static void stopTimer(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  elapsed = (now.tv_sec - started.tv_sec) * 1e9 + (now.tv_nsec - started.tv_nsec);
+  allocs = allocCount - allocsAtStart;
+}
+
+//a 2 player game with card among its kingdom piles
+static void setUpGame(struct gameState *state, int card) {
+  int k[10];
+  int i;
+
+  memcpy(k, kingdom, sizeof(k));
+  for (i = 0; i < 10 && k[i] != card; i++)
+    ;
+  if (i == 10)
+    k[9] = card;
+  initializeGame(2, k, 1, state);
+}
+
+//player 0's deck set to size cards
+static void fillDeck(struct gameState *state, int size) {
+  static const int mix[] = {copper, copper, copper, estate, silver, smithy, gold, village};
+  int i;
+
+  for (i = 0; i < size; i++)
+    state->deck[0][i] = supplyPile(mix[i % 8], state);
+  state->deckCount[0] = size;
+  recountCards(0, state);
+  rehashGameState(state);
+}
+
+static void benchShuffle(long n, int size) {
+  long i;
+
+  setUpGame(&G, smithy);
+  fillDeck(&G, size);
+  startTimer();
+  for (i = 0; i < n; i++)
+    shuffle(0, &G);
+  stopTimer();
+}
+
+//draws off a deck of 300, set back every 200 draws
+static void benchDrawCard(long n, int arg) {
+  long i;
+
+  setUpGame(&T, smithy);
+  fillDeck(&T, 300);
+  copyGameState(&G, &T);
+  startTimer();
+  for (i = 0; i < n; i++)
+    {
+      if (G.deckCount[0] <= 100)
+	copyGameState(&G, &T);
+      drawCard(0, &G);
+    }
+  stopTimer();
+}
+
+static void benchUpdateCoins(long n, int arg) {
+  long i;
+
+  setUpGame(&G, smithy);
+  startTimer();
+  for (i = 0; i < n; i++)
+    updateCoinsCall(0, &G, 0);
+  stopTimer();
+  sink = G.coins;
+}
+
+static void benchScoreFor(long n, int arg) {
+  long i;
+
+  setUpGame(&G, smithy);
+  startTimer();
+  for (i = 0; i < n; i++)
+    sink = scoreForCall(0, &G);
+  stopTimer();
+}
+
+static void benchIsGameOver(long n, int arg) {
+  long i;
+
+  setUpGame(&G, smithy);
+  startTimer();
+  for (i = 0; i < n; i++)
+    sink = isGameOverCall(&G);
+  stopTimer();
+}
+
+//turns with nothing played or bought, so the game never ends
+static void benchEndTurn(long n, int arg) {
+  long i;
+
+  setUpGame(&G, smithy);
+  startTimer();
+  for (i = 0; i < n; i++)
+    endTurn(&G);
+  stopTimer();
+}
+
+static void benchCopyGameState(long n, int arg) {
+  long i;
+
+  setUpGame(&T, smithy);
+  startTimer();
+  for (i = 0; i < n; i++)
+    copyGameState(&G, &T);
+  stopTimer();
+}
+
+//choices that make card's effect go through from the hand
+//card, Copper, Estate, Silver, card
+static void effectChoices(int card, int choice[3]) {
+  choice[0] = choice[1] = choice[2] = 0;
+  switch (card)
+    {
+    case feast:
+    case embargo:
+      choice[0] = silver;
+      break;
+    case mine:
+      choice[0] = 1;
+      choice[1] = silver;
+      break;
+    case remodel:
+      choice[0] = 2;
+      choice[1] = smithy;
+      break;
+    case ambassador:
+      choice[0] = 2;
+      choice[1] = 1;
+      break;
+    case salvager:
+      choice[0] = 2;
+      break;
+    case baron:
+    case minion:
+    case steward:
+      choice[0] = 1;
+      break;
+    }
+}
+
+static void effectHand(int card, struct gameState *state) {
+  int hand[5] = {card, copper, estate, silver, card};
+  int i;
+
+  for (i = 0; i < 5; i++)
+    state->hand[0][i] = supplyPile(hand[i], state);
+  state->handCount[0] = 5;
+  recountCards(0, state);
+  rehashGameState(state);
+}
+
+static void benchCardEffect(long n, int card) {
+  int choice[3];
+  int bonus;
+  long i;
+
+  setUpGame(&T, card);
+  effectHand(card, &T);
+  effectChoices(card, choice);
+
+  //time the card doing something, not the engine refusing it
+  copyGameState(&G, &T);
+  bonus = 0;
+  if (cardEffect(card, choice[0], choice[1], choice[2], &G, 0, &bonus) < 0)
+    fprintf(stderr, "cardEffect(%d) fails from the benchmark's hand\n", card);
+
+  startTimer();
+  for (i = 0; i < n; i++)
+    {
+      copyGameState(&G, &T);
+      bonus = 0;
+      sink = cardEffect(card, choice[0], choice[1], choice[2], &G, 0, &bonus);
+    }
+  stopTimer();
+}
+
+//smithy against adventurer, as simulate plays them
+static void benchGame(long n, int arg) {
+  const struct strategy *s[2];
+  struct botMemory mem[2];
+  int turns;
+  long i;
+
+  s[0] = findStrategy("smithy");
+  s[1] = findStrategy("adventurer");
+  startTimer();
+  for (i = 0; i < n; i++)
+    {
+      initializeGameOpts(2, gameKingdom, i + 1, arg, &G);
+      memset(mem, 0, sizeof(mem));
+      mem[1].player = 1;
+      for (turns = 0; turns < MAX_TURNS && !isGameOver(&G); turns++)
+	playStrategyTurn(s[whoseTurn(&G)], &mem[whoseTurn(&G)], &G, NULL);
+    }
+  stopTimer();
+}
+
+//bigmoney against itself on the batch engine, BATCH_GAMES at a time
+static void benchBatch(long n, int arg) {
+  const struct batchBot *bots[MAX_PLAYERS];
+  struct batchGames b;
+  long left;
+  int size;
+
+  bots[0] = bots[1] = findBatchBot("bigmoney");
+  startTimer();
+  for (left = n; left > 0; left -= size)
+    {
+      size = left < BATCH_GAMES ? left : BATCH_GAMES;
+      initBatch(&b, size, 2, left);
+      playBatch(&b, bots, MAX_TURNS);
+      freeBatch(&b);
+    }
+  stopTimer();
+}
+
+static void addBenchmark(const char *name, void (*run)(long n, int arg), int arg) {
+  struct benchmark *b = &benchmarks[numBenchmarks++];
+
+  snprintf(b->name, MAX_NAME, "%s", name);
+  b->run = run;
+  b->arg = arg;
+}
+
+//cardEffect/<card name>, lower case with underscores
+static void addCardEffect(int card) {
+  char cardName[MAX_STRING_LENGTH];
+  char name[MAX_NAME];
+  int i;
+
+  cardNumToName(card, cardName);
+  for (i = 0; cardName[i] != '\0'; i++)
+    cardName[i] = cardName[i] == ' ' ? '_' : tolower((unsigned char) cardName[i]);
+  snprintf(name, MAX_NAME, "cardEffect/%s", cardName);
+  addBenchmark(name, benchCardEffect, card);
+}
+
+static int loadBase(const char *path) {
+  char line[256];
+  long iterations;
+  FILE *file = fopen(path, "r");
+
+  if (file == NULL)
+    return -1;
+  while (numBase < MAX_BENCHMARKS && fgets(line, sizeof(line), file) != NULL)
+    {
+      if (sscanf(line, "%63s %ld %lf", base[numBase].name, &iterations, &base[numBase].ns) == 3)
+	numBase++;
+    }
+  fclose(file);
+  return 0;
+}
+
+static double baseNs(const char *name) {
+  int i;
+
+  for (i = 0; i < numBase; i++)
+    if (strcmp(base[i].name, name) == 0)
+      return base[i].ns;
+  return -1;
+}
+
+//n doubled until one run takes seconds, then the best of three runs
+static void runBenchmark(struct benchmark *b, double seconds) {
+  double best, bestAllocs, ns, old;
+  long n = 1;
+  int i;
+
+  for (;;)
+    {
+      b->run(n, b->arg);
+      if (elapsed >= seconds * 1e9 || n >= (1L << 40))
+	break;
+      n = elapsed < seconds * 1e7 ? n * 100 : n * 2;
+    }
+
+  best = elapsed;
+  bestAllocs = allocs;
+  for (i = 0; i < 2; i++)
+    {
+      b->run(n, b->arg);
+      if (elapsed < best)
+	best = elapsed;
+    }
+
+  ns = best / n;
+  printf("%s\t%ld\t%.2f\t%.0f\t%.4f", b->name, n, ns, 1e9 / ns,
+	 allocCount < 0 ? -1 : bestAllocs / n);
+  if (numBase > 0)
+    {
+      old = baseNs(b->name);
+      if (old > 0)
+	printf("\t%.2f\t%+.1f%%", old, 100 * (ns - old) / old);
+      else
+	printf("\t-\t-");
+    }
+  printf("\n");
+  fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+  const char *filter = NULL;
+  double seconds = 0.2;
+  int i, card;
+
+  for (i = 1; i < argc; i++)
+    {
+      if (strncmp(argv[i], "seconds=", 8) == 0)
+	seconds = atof(argv[i] + 8);
+      else if (strncmp(argv[i], "base=", 5) == 0)
+	{
+	  if (loadBase(argv[i] + 5) < 0)
+	    {
+	      fprintf(stderr, "Could not read %s\n", argv[i] + 5);
+	      return 1;
+	    }
+	}
+      else
+	filter = argv[i];
+    }
+  if (seconds <= 0)
+    {
+      printf("Usage: bench [<filter>] [seconds=<s>] [base=<file>]\n");
+      return 1;
+    }
+
+  addBenchmark("shuffle/10", benchShuffle, 10);
+  addBenchmark("shuffle/40", benchShuffle, 40);
+  addBenchmark("drawCard", benchDrawCard, 0);
+  addBenchmark("updateCoins", benchUpdateCoins, 0);
+  addBenchmark("scoreFor", benchScoreFor, 0);
+  addBenchmark("isGameOver", benchIsGameOver, 0);
+  addBenchmark("endTurn", benchEndTurn, 0);
+  addBenchmark("copyGameState", benchCopyGameState, 0);
+  for (card = adventurer; card <= treasure_map; card++)
+    {
+      if (getCardInfo(card)->effect != NULL)
+	addCardEffect(card);
+    }
+  addBenchmark("game/smithy_vs_adventurer", benchGame, 0);
+  addBenchmark("game/smithy_vs_adventurer_fast", benchGame, GAME_FAST_RNG);
+  addBenchmark("game/bigmoney_batch", benchBatch, 0);
+
+  printf("benchmark\titerations\tns_per_op\tops_per_sec\tallocs_per_op");
+  if (numBase > 0)
+    printf("\tbase_ns_per_op\tchange");
+  printf("\n");
+
+  for (i = 0; i < numBenchmarks; i++)
+    {
+      if (filter == NULL || strstr(benchmarks[i].name, filter) != NULL)
+	runBenchmark(&benchmarks[i], seconds);
+    }
+
+  return 0;
+}
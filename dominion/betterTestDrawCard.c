@@ -55,11 +55,11 @@ int main () {
 	  memset(&G, 23, sizeof(struct gameState)); 
 	  r = initializeGame(2, k, 1, &G);
 	  G.deckCount[p] = deckCount;
-	  memset(G.deck[p], 0, sizeof(int) * deckCount);
+	  memset(G.deck[p], 0, sizeof(card_t) * deckCount);
 	  G.discardCount[p] = discardCount;
-	  memset(G.discard[p], 0, sizeof(int) * discardCount);
+	  memset(G.discard[p], 0, sizeof(card_t) * discardCount);
 	  G.handCount[p] = handCount;
-	  memset(G.hand[p], 0, sizeof(int) * handCount);
+	  memset(G.hand[p], 0, sizeof(card_t) * handCount);
 	  checkDrawCard(p, &G);
 	}
       }
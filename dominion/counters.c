@@ -0,0 +1,109 @@
+/* 	Hot-path counters
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "counters.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const char *counterNames[NUM_COUNTERS] = {
+  "shuffle", "reshuffles", "draw calls", "cards drawn", "playCard",
+  "playCard failed", "buyCard", "buyCard failed", "gainCard", "endTurn",
+  "updateCoins", "isGameOver", "scoreFor"
+};
+
+__thread struct counters *threadCounters = NULL;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static struct counters *allCounters = NULL;
+static int numThreads = 0;
+
+static void reportAtExit(void) {
+  reportCounters(stderr);
+}
+
+struct counters *newCounters(void) {
+  struct counters *c;
+
+  if (threadCounters != NULL)
+    return threadCounters;
+
+  //never freed: the report at exit still needs the threads that ended
+  c = calloc(1, sizeof(struct counters));
+  if (c == NULL)
+    abort();
+
+  pthread_mutex_lock(&lock);
+  if (allCounters == NULL)
+    atexit(reportAtExit);
+  c->next = allCounters;
+  allCounters = c;
+  numThreads++;
+  pthread_mutex_unlock(&lock);
+
+  threadCounters = c;
+  return c;
+}
+
+unsigned long long readCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long) now.tv_sec * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+void totalCounters(struct counters *total) {
+  struct counters *c;
+  int i;
+
+  memset(total, 0, sizeof(struct counters));
+  pthread_mutex_lock(&lock);
+  for (c = allCounters; c != NULL; c = c->next)
+    {
+      for (i = 0; i < NUM_COUNTERS; i++)
+	total->count[i] += c->count[i];
+      for (i = 0; i < MAX_CARDS; i++)
+	{
+	  total->gained[i] += c->gained[i];
+	  total->effects[i] += c->effects[i];
+	  total->effectCycles[i] += c->effectCycles[i];
+	}
+    }
+  pthread_mutex_unlock(&lock);
+}
+
+void reportCounters(FILE *out) {
+  struct counters total;
+  const struct cardInfo *info;
+  int i;
+
+  totalCounters(&total);
+
+  fprintf(out, "counters, %d threads:\n", numThreads);
+  for (i = 0; i < NUM_COUNTERS; i++)
+    fprintf(out, "  %-16s %12ld\n", counterNames[i], total.count[i]);
+
+  fprintf(out, "  %-16s %12s %12s %12s\n", "card", "gained", "effects", "cycles/effect");
+  for (i = 0; i < MAX_CARDS; i++)
+    {
+      if (total.gained[i] == 0 && total.effects[i] == 0)
+	continue;
+      info = getCardInfo(i);
+      fprintf(out, "  %-16s %12ld %12ld %12.0f\n", info != NULL ? info->name : "?",
+	      total.gained[i], total.effects[i],
+	      total.effects[i] > 0 ? (double) total.effectCycles[i] / total.effects[i] : 0.0);
+    }
+}
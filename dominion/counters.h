@@ -0,0 +1,82 @@
+/* 	Hot-path counters
+
+	Counts of engine calls, reshuffles, cards drawn, cards gained of
+	each card, failed plays and buys, and the cycles each card's effect
+	takes.  Compiled in only with -DCOUNTERS (make COUNTERS=1); without
+	it every COUNT macro is empty, so the engine pays nothing.
+
+	Each thread counts into its own block, so counting needs no locks
+	or atomics.  The blocks are kept after their threads end, and at
+	exit they are added up and the report is written to stderr.
+*/
+
+#ifndef _COUNTERS_H
+#define _COUNTERS_H
+
+#include <stdio.h>
+#include "dominion.h"
+
+enum counter {
+  COUNT_SHUFFLE = 0,
+  COUNT_RESHUFFLE,          /* empty deck, discard shuffled back in */
+  COUNT_DRAW_CALL,          /* drawCard and drawCards calls, not cards */
+  COUNT_CARDS_DRAWN,
+  COUNT_PLAY_CARD,
+  COUNT_PLAY_CARD_FAILED,
+  COUNT_BUY_CARD,
+  COUNT_BUY_CARD_FAILED,
+  COUNT_GAIN_CARD,
+  COUNT_END_TURN,
+  COUNT_UPDATE_COINS,
+  COUNT_IS_GAME_OVER,
+  COUNT_SCORE_FOR,
+  NUM_COUNTERS
+};
+
+struct counters {
+  long count[NUM_COUNTERS];
+  long gained[MAX_CARDS];                   /* cards gained from each pile */
+  long effects[MAX_CARDS];                  /* cardEffect calls of each card */
+  unsigned long long effectCycles[MAX_CARDS];
+  struct counters *next;                    /* the next thread's block */
+};
+
+struct counters *newCounters(void);
+/* The calling thread's block, made and registered on first use */
+
+unsigned long long readCycles(void);
+/* The time stamp counter on x86, nanoseconds elsewhere */
+
+void totalCounters(struct counters *total);
+/* Every thread's counts added up.  Threads still running may be
+   part way through a count */
+
+void reportCounters(FILE *out);
+/* Write the totals, which is done at exit to stderr */
+
+#ifdef COUNTERS
+
+extern __thread struct counters *threadCounters;
+
+static inline struct counters *myCounters(void) {
+  return threadCounters != NULL ? threadCounters : newCounters();
+}
+
+#define COUNT(c) (myCounters()->count[c]++)
+#define COUNT_ADD(c, n) (myCounters()->count[c] += (n))
+#define COUNT_GAIN(card) (myCounters()->gained[card]++)
+#define COUNT_TIMER(t) unsigned long long t = readCycles()
+#define COUNT_EFFECT(card, t) (myCounters()->effects[card]++, \
+			       myCounters()->effectCycles[card] += readCycles() - (t))
+
+#else
+
+#define COUNT(c) ((void) 0)
+#define COUNT_ADD(c, n) ((void) 0)
+#define COUNT_GAIN(card) ((void) 0)
+#define COUNT_TIMER(t) ((void) 0)
+#define COUNT_EFFECT(card, t) ((void) 0)
+
+#endif
+
+#endif
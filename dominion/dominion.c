@@ -1,23 +1,330 @@
 #include "dominion.h"
 #include "dominion_helpers.h"
 #include "rngs.h"
+#include "counters.h"
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
 
 int compare(const void* a, const void* b) {
-  if (*(int*)a > *(int*)b)
+  if (*(card_t*)a > *(card_t*)b)
     return 1;
-  if (*(int*)a < *(int*)b)
+  if (*(card_t*)a < *(card_t*)b)
     return -1;
   return 0;
 }
 
+static int adventurerEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int councilRoomEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int feastEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int mineEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int remodelEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int smithyEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int villageEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int baronEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int greatHallEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int minionEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int stewardEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int tributeEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int ambassadorEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int cutpurseEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int embargoEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int outpostEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int salvagerEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int seaHagEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+static int treasureMapEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+
+static int vanillaEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus);
+
+//what the engine knows about each card, indexed by card: the built-in
+//cards, then the ones addCard adds.  vp is the printed value (Gardens is
+//scored separately); a card with no effect cannot be played
+static struct cardInfo cards[MAX_CARDS] = {
+  /* name, cost, types, coins, vp */
+  {"Curse", 0, 0, 0, -1},
+  {"Estate", 2, CARD_VICTORY, 0, 1},
+  {"Duchy", 5, CARD_VICTORY, 0, 3},
+  {"Province", 8, CARD_VICTORY, 0, 6},
+  {"Copper", 0, CARD_TREASURE, 1, 0},
+  {"Silver", 3, CARD_TREASURE, 2, 0},
+  {"Gold", 6, CARD_TREASURE, 3, 0},
+  {"Adventurer", 6, CARD_ACTION, .effect = adventurerEffect},
+  {"Council Room", 5, CARD_ACTION, .effect = councilRoomEffect},
+  {"Feast", 4, CARD_ACTION, .effect = feastEffect},
+  {"Gardens", 4, CARD_VICTORY},
+  {"Mine", 5, CARD_ACTION, .effect = mineEffect},
+  {"Remodel", 4, CARD_ACTION, .effect = remodelEffect},
+  {"Smithy", 4, CARD_ACTION, .effect = smithyEffect},
+  {"Village", 3, CARD_ACTION, .effect = villageEffect},
+  {"Baron", 4, CARD_ACTION, .effect = baronEffect},
+  {"Great Hall", 3, CARD_ACTION | CARD_VICTORY, 0, 1, .effect = greatHallEffect},
+  {"Minion", 5, CARD_ACTION | CARD_ATTACK, .effect = minionEffect},
+  {"Steward", 3, CARD_ACTION, .effect = stewardEffect},
+  {"Tribute", 5, CARD_ACTION, .effect = tributeEffect},
+  {"Ambassador", 3, CARD_ACTION, .effect = ambassadorEffect},
+  {"Cutpurse", 4, CARD_ACTION | CARD_ATTACK, .effect = cutpurseEffect},
+  {"Embargo", 2, CARD_ACTION, .effect = embargoEffect},
+  {"Outpost", 5, CARD_ACTION, .effect = outpostEffect},
+  {"Salvager", 4, CARD_ACTION, .effect = salvagerEffect},
+  {"Sea Hag", 4, CARD_ACTION | CARD_ATTACK, .effect = seaHagEffect},
+  {"Treasure Map", 4, CARD_ACTION, .effect = treasureMapEffect}
+};
+
+static int cardCount = treasure_map + 1;
+
+//set when the first game is set up, after which addCard refuses cards:
+//games read the table without locks
+static int cardsFrozen = 0;
+
+//Zobrist-style keys for hashGameState.  A position hashes to the sum of
+//key * value over its counters (cards left in each supply pile, embargo
+//tokens on it, copies of each pile's card in each player pile, ...), so
+//when a counter moves by delta the hash just adds key * delta
+#define HASH_SUPPLY 0
+#define HASH_EMBARGO MAX_SUPPLY
+#define HASH_PLAYED (2 * MAX_SUPPLY)
+#define HASH_PILE(player, pile) ((3 + (player) * 3 + (pile)) * MAX_SUPPLY)
+#define HASH_HAND 0
+#define HASH_DECK 1
+#define HASH_DISCARD 2
+#define HASH_SCALAR HASH_PILE(MAX_PLAYERS, 0)
+
+static unsigned long long hashKey(int slot) {
+  unsigned long long z = (slot + 1) * 0x9E3779B97F4A7C15ULL;
+
+  //SplitMix64's finalizer, any good 64-bit mix would do
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+//adjust hash as the counter for the card of pile at base moves by delta
+static void hashCard(unsigned long long *hash, int base, int pile, int delta) {
+  if (pile >= 0 && pile < MAX_SUPPLY)
+    *hash += (unsigned long long) delta * hashKey(base + pile);
+}
+
+//one noted field in an undo log, written after the bytes it saved; a
+//size of 0 marks where a record starts
+struct undoEntry {
+  unsigned short offset;
+  unsigned short size;
+};
+
+//room for need more bytes in log, doubling buf as it fills.  If it
+//cannot grow the records are dropped and overflow is set
+static int growUndo(struct undoLog *log, int need) {
+  int size = log->size > 0 ? log->size : 4096;
+  unsigned char *buf;
+
+  if (log->used + need <= log->size)
+    return 0;
+  while (size < log->used + need)
+    size *= 2;
+  buf = realloc(log->buf, size);
+  if (buf == NULL)
+    {
+      log->overflow = 1;
+      log->used = 0;
+      log->moves = 0;
+      return -1;
+    }
+  log->buf = buf;
+  log->size = size;
+  return 0;
+}
+
+//note the size bytes of state at field before the recorded move changes
+//them, so undoMove can write them back.  Does nothing without a log or
+//an open record
+static void keep(struct gameState *state, const void *field, int size) {
+  struct undoLog *log = state->undo;
+  struct undoEntry entry;
+  long offset;
+
+  if (log == NULL || log->moves < 1 || size <= 0)
+    return;
+  offset = (const unsigned char *) field - (const unsigned char *) state;
+  if (offset < 0 || offset + size > (long) sizeof(struct gameState))
+    return;
+  if (growUndo(log, size + sizeof(entry)) < 0)
+    return;
+
+  entry.offset = offset;
+  entry.size = size;
+  memcpy(log->buf + log->used, field, size);
+  memcpy(log->buf + log->used + size, &entry, sizeof(entry));
+  log->used += size + sizeof(entry);
+}
+
+#define KEEP(field) keep(state, &(field), sizeof(field))
+
+//the table entry of the card of pile, NULL for an empty slot or junk
+static const struct cardInfo *pileInfo(int pile, struct gameState *state) {
+  int card;
+
+  if (pile < 0 || pile >= state->numPiles || pile >= MAX_SUPPLY)
+    return NULL;
+  card = state->supplyCard[pile];
+  if (card < curse || card >= cardCount)
+    return NULL;
+  return &cards[card];
+}
+
+//adjust the treasure value of player's hand as the card of pile enters
+//(1) or leaves (-1)
+static void countHand(int player, int pile, int delta, struct gameState *state) {
+  const struct cardInfo *info = pileInfo(pile, state);
+
+  if (info != NULL)
+    {
+      KEEP(state->handCoins[player]);
+      KEEP(state->pileHash[player]);
+      state->handCoins[player] += delta * info->coins;
+      hashCard(&state->pileHash[player], HASH_PILE(player, HASH_HAND), pile, delta);
+    }
+}
+
+//move the supply of card by delta, keeping the hash and the count of
+//empty piles current; every supply change after setup goes through here
+static void changeSupply(int card, int delta, struct gameState *state) {
+  int pile = supplyPile(card, state);
+
+  if (pile >= 0)
+    {
+      KEEP(state->emptyPiles);
+      KEEP(state->pileCount[pile]);
+      KEEP(state->hash);
+      state->emptyPiles -= state->pileCount[pile] == 0;
+      state->pileCount[pile] += delta;
+      state->emptyPiles += state->pileCount[pile] == 0;
+      hashCard(&state->hash, HASH_SUPPLY, pile, delta);
+    }
+}
+
+//adjust the count of the card of pile owned by player, ignoring empty
+//(-1) slots
+static void countCard(int player, int pile, int delta, struct gameState *state) {
+  const struct cardInfo *info = pileInfo(pile, state);
+
+  if (info != NULL)
+    {
+      KEEP(state->ownedCount[player][pile]);
+      KEEP(state->ownedTotal[player]);
+      KEEP(state->victoryPoints[player]);
+      state->ownedCount[player][pile] += delta;
+      state->ownedTotal[player] += delta;
+      state->victoryPoints[player] += delta * info->vp;
+    }
+}
+
+int recountCards(int player, struct gameState *state) {
+  struct undoLog *log = state->undo;
+  int i;
+
+  //everything below changes only these, so note them once and count
+  //without the log
+  KEEP(state->ownedCount[player]);
+  KEEP(state->ownedTotal[player]);
+  KEEP(state->victoryPoints[player]);
+  KEEP(state->handCoins[player]);
+  KEEP(state->pileHash[player]);
+  state->undo = NULL;
+
+  memset(state->ownedCount[player], 0, sizeof(state->ownedCount[player]));
+  state->ownedTotal[player] = 0;
+  state->victoryPoints[player] = 0;
+  state->handCoins[player] = 0;
+  state->pileHash[player] = 0;
+
+  for (i = 0; i < state->deckCount[player]; i++)
+    {
+      countCard(player, state->deck[player][i], 1, state);
+      hashCard(&state->pileHash[player], HASH_PILE(player, HASH_DECK), state->deck[player][i], 1);
+    }
+  for (i = 0; i < state->handCount[player]; i++)
+    {
+      countCard(player, state->hand[player][i], 1, state);
+      countHand(player, state->hand[player][i], 1, state);
+    }
+  for (i = 0; i < state->discardCount[player]; i++)
+    {
+      countCard(player, state->discard[player][i], 1, state);
+      hashCard(&state->pileHash[player], HASH_PILE(player, HASH_DISCARD), state->discard[player][i], 1);
+    }
+  state->undo = log;
+
+  return 0;
+}
+
+int rehashGameState(struct gameState *state) {
+  int i;
+
+  KEEP(state->hash);
+  KEEP(state->emptyPiles);
+  state->hash = 0;
+  state->emptyPiles = 0;
+  for (i = 0; i < state->numPiles; i++)
+    {
+      state->emptyPiles += state->pileCount[i] == 0;
+      hashCard(&state->hash, HASH_SUPPLY, i, state->pileCount[i]);
+      hashCard(&state->hash, HASH_EMBARGO, i, state->embargoTokens[i]);
+    }
+  for (i = 0; i < state->playedCardCount; i++)
+    hashCard(&state->hash, HASH_PLAYED, state->playedCards[i], 1);
+
+  for (i = 0; i < state->numPlayers && i < MAX_PLAYERS; i++)
+    recountCards(i, state);
+
+  return 0;
+}
+
+unsigned long long hashGameState(struct gameState *state) {
+  unsigned long long hash = state->hash;
+  int i;
+
+  for (i = 0; i < state->numPlayers && i < MAX_PLAYERS; i++)
+    hash += state->pileHash[i];
+
+  //the few scalars change all over cardEffect, so they are added here
+  hash += state->whoseTurn * hashKey(HASH_SCALAR);
+  hash += state->phase * hashKey(HASH_SCALAR + 1);
+  hash += state->numActions * hashKey(HASH_SCALAR + 2);
+  hash += state->numBuys * hashKey(HASH_SCALAR + 3);
+  hash += state->coins * hashKey(HASH_SCALAR + 4);
+  hash += state->outpostPlayed * hashKey(HASH_SCALAR + 5);
+
+  return hash;
+}
+
 struct gameState* newGame() {
   struct gameState* g = malloc(sizeof(struct gameState));
   return g;
 }
 
+int copyGameState(struct gameState *dest, struct gameState *src) {
+  int i;
+
+  if (dest == src)
+    return 0;
+
+  //everything up to the piles is small and fixed size
+  memcpy(dest, src, offsetof(struct gameState, hand));
+  dest->undo = NULL;
+
+  for (i = 0; i < src->numPlayers && i < MAX_PLAYERS; i++)
+    {
+      memcpy(dest->hand[i], src->hand[i], src->handCount[i] * sizeof(card_t));
+      memcpy(dest->deck[i], src->deck[i], src->deckCount[i] * sizeof(card_t));
+      memcpy(dest->discard[i], src->discard[i], src->discardCount[i] * sizeof(card_t));
+    }
+  memcpy(dest->playedCards, src->playedCards, src->playedCardCount * sizeof(card_t));
+
+  return 0;
+}
+
 int* kingdomCards(int k1, int k2, int k3, int k4, int k5, int k6, int k7,
 		  int k8, int k9, int k10) {
   int* k = malloc(10 * sizeof(int));
@@ -36,13 +343,47 @@ int* kingdomCards(int k1, int k2, int k3, int k4, int k5, int k6, int k7,
 
 int initializeGame(int numPlayers, int kingdomCards[10], int randomSeed,
 		   struct gameState *state) {
+  return initializeGameOpts(numPlayers, kingdomCards, randomSeed, 0, state);
+}
+
+int initializeGameOpts(int numPlayers, int kingdomCards[10], int randomSeed,
+		       int options, struct gameState *state) {
+  return initializeGameSupply(numPlayers, kingdomCards, 10, randomSeed, options, state);
+}
+
+//open a supply pile of count cards, piles are kept in card order
+static void addPile(int card, int count, struct gameState *state) {
+  int i = state->numPiles;
+
+  while (i > 0 && state->supplyCard[i-1] > card)
+    {
+      state->supplyCard[i] = state->supplyCard[i-1];
+      state->pileCount[i] = state->pileCount[i-1];
+      i--;
+    }
+  state->supplyCard[i] = card;
+  state->pileCount[i] = count;
+  state->numPiles++;
+}
+
+int initializeGameSupply(int numPlayers, const int *kingdomCards, int numKingdom,
+			 int randomSeed, int options, struct gameState *state) {
 
   int i;
   int j;
-  int it;			
-  //set up random number generator
-  SelectStream(1);
-  PutSeed((long)randomSeed);
+  int victory;
+  rngStream streams[MAX_PLAYERS+1];
+
+  state->undo = NULL;
+  cardsFrozen = 1;
+
+  //set up random number generator, stream 0 for the game and one more
+  //per player for GAME_CRN
+  PlantSeedsStream(streams, MAX_PLAYERS+1,
+		   (options & GAME_FAST_RNG) ? RNG_SPLITMIX : RNG_LEHMER,
+		   (long)randomSeed);
+  state->rng = streams[0];
+  memcpy(state->deckRng, &streams[1], sizeof(state->deckRng));
   
   //check number of players
   if (numPlayers > MAX_PLAYERS || numPlayers < 2)
@@ -52,11 +393,20 @@ int initializeGame(int numPlayers, int kingdomCards[10], int randomSeed,
 
   //set number of players
   state->numPlayers = numPlayers;
+  state->options = options;
 
-  //check selected kingdom cards are different
-  for (i = 0; i < 10; i++)
+  //check selected kingdom cards are different kingdom cards in the pool
+  if (numKingdom < 0 || numKingdom > MAX_KINGDOM)
+    {
+      return -1;
+    }
+  for (i = 0; i < numKingdom; i++)
     {
-      for (j = 0; j < 10; j++)
+      if (kingdomCards[i] < adventurer || kingdomCards[i] >= cardCount)
+	{
+	  return -1;
+	}
+      for (j = 0; j < numKingdom; j++)
         {
 	  if (j != i && kingdomCards[j] == kingdomCards[i])
 	    {
@@ -69,66 +419,28 @@ int initializeGame(int numPlayers, int kingdomCards[10], int randomSeed,
   //initialize supply
   ///////////////////////////////
 
+  state->numPiles = 0;
+  memset(state->supplyCard, -1, sizeof(state->supplyCard));
+  memset(state->pileCount, -1, sizeof(state->pileCount));
+  victory = (numPlayers == 2) ? 8 : 12;
+
   //set number of Curse cards
-  if (numPlayers == 2)
-    {
-      state->supplyCount[curse] = 10;
-    }
-  else if (numPlayers == 3)
-    {
-      state->supplyCount[curse] = 20;
-    }
-  else
-    {
-      state->supplyCount[curse] = 30;
-    }
+  addPile(curse, 10 * (numPlayers - 1), state);
 
   //set number of Victory cards
-  if (numPlayers == 2)
-    {
-      state->supplyCount[estate] = 8;
-      state->supplyCount[duchy] = 8;
-      state->supplyCount[province] = 8;
-    }
-  else
-    {
-      state->supplyCount[estate] = 12;
-      state->supplyCount[duchy] = 12;
-      state->supplyCount[province] = 12;
-    }
+  addPile(estate, victory, state);
+  addPile(duchy, victory, state);
+  addPile(province, victory, state);
 
   //set number of Treasure cards
-  state->supplyCount[copper] = 60 - (7 * numPlayers);
-  state->supplyCount[silver] = 40;
-  state->supplyCount[gold] = 30;
+  addPile(copper, 60 - (7 * numPlayers), state);
+  addPile(silver, 40, state);
+  addPile(gold, 30, state);
 
-  //set number of Kingdom cards
-  for (i = adventurer; i <= treasure_map; i++)       	//loop all cards
+  //set number of Kingdom cards, Victory ones as many as the Victory piles
+  for (j = 0; j < numKingdom; j++)
     {
-      for (j = 0; j < 10; j++)           		//loop chosen cards
-	{
-	  if (kingdomCards[j] == i)
-	    {
-	      //check if card is a 'Victory' Kingdom card
-	      if (kingdomCards[j] == great_hall || kingdomCards[j] == gardens)
-		{
-		  if (numPlayers == 2){ 
-		    state->supplyCount[i] = 8; 
-		  }
-		  else{ state->supplyCount[i] = 12; }
-		}
-	      else
-		{
-		  state->supplyCount[i] = 10;
-		}
-	      break;
-	    }
-	  else    //card is not in the set choosen for the game
-	    {
-	      state->supplyCount[i] = -1;
-	    }
-	}
-
+      addPile(kingdomCards[j], (cards[kingdomCards[j]].types & CARD_VICTORY) ? victory : 10, state);
     }
 
   ////////////////////////
@@ -165,6 +477,7 @@ int initializeGame(int numPlayers, int kingdomCards[10], int randomSeed,
       //initialize hand size to zero
       state->handCount[i] = 0;
       state->discardCount[i] = 0;
+      recountCards(i, state);
       //draw 5 cards
       // for (j = 0; j < 5; j++)
       //	{
@@ -173,7 +486,7 @@ int initializeGame(int numPlayers, int kingdomCards[10], int randomSeed,
     }
   
   //set embargo tokens to 0 for all supply piles
-  for (i = 0; i <= treasure_map; i++)
+  for (i = 0; i < MAX_SUPPLY; i++)
     {
       state->embargoTokens[i] = 0;
     }
@@ -186,49 +499,98 @@ int initializeGame(int numPlayers, int kingdomCards[10], int randomSeed,
   state->playedCardCount = 0;
   state->whoseTurn = 0;
   state->handCount[state->whoseTurn] = 0;
-  //int it; move to top
 
   //Moved draw cards to here, only drawing at the start of a turn
-  for (it = 0; it < 5; it++){
-    drawCard(state->whoseTurn, state);
-  }
+  drawCards(state->whoseTurn, 5, state);
 
   updateCoins(state->whoseTurn, state, 0);
 
+  rehashGameState(state);
+
   return 0;
 }
 
 int shuffle(int player, struct gameState *state) {
  
 
-  int newDeck[MAX_DECK];
+  card_t newDeck[MAX_DECK];
   int newDeckPos = 0;
-  int card;
+  card_t *deck = state->deck[player];
+  int n = state->deckCount[player];
+  rngStream *rng = (state->options & GAME_CRN) ? &state->deckRng[player] : &state->rng;
+  int counts[MAX_SUPPLY];
+  int piles = state->numPiles < MAX_SUPPLY ? state->numPiles : MAX_SUPPLY; //junk must not run past counts
+  int next = 0;
+  card_t sorted;
+  int card, pile;
   int i;
 
-  if (state->deckCount[player] < 1)
+  COUNT(COUNT_SHUFFLE);
+  if (n < 1 || n > MAX_DECK)
     return -1;
-  qsort ((void*)(state->deck[player]), state->deckCount[player], sizeof(int), compare); 
-  /* SORT CARDS IN DECK TO ENSURE DETERMINISM! */
+  keep(state, rng, sizeof(rngStream));
+  keep(state, deck, n * sizeof(card_t));
+
+  /* SORT CARDS IN DECK TO ENSURE DETERMINISM! A deck holds piles, which
+     are in card order, so count them instead of calling qsort */
+  memset(counts, 0, sizeof(counts));
+  for (i = 0; i < n; i++) {
+    pile = deck[i];
+    if (pile < 0 || pile >= piles)
+      break;
+    counts[pile]++;
+  }
+  if (i < n) {
+    //not a real deck (empty slots or junk), sort it the slow way
+    qsort ((void*)deck, n, sizeof(card_t), compare); 
+    memset(counts, 0, sizeof(counts));
+    next = piles;
+  }
+
+  if (state->options & GAME_LEGACY_SHUFFLE) {
+    for (i = 0; next < piles; next++) {
+      for (card = 0; card < counts[next]; card++)
+	deck[i++] = next;
+    }
 
-  while (state->deckCount[player] > 0) {
-    card = floor(Random() * state->deckCount[player]);
-    newDeck[newDeckPos] = state->deck[player][card];
-    newDeckPos++;
-    for (i = card; i < state->deckCount[player]-1; i++) {
-      state->deck[player][i] = state->deck[player][i+1];
+    //pull random cards out one at a time, closing the gap each time
+    while (n > 0) {
+      card = RandomBelow(rng, n);
+      newDeck[newDeckPos] = deck[card];
+      newDeckPos++;
+      memmove(&deck[card], &deck[card+1], (n-1-card) * sizeof(card_t));
+      n--;
     }
-    state->deckCount[player]--;
+    memcpy(deck, newDeck, newDeckPos * sizeof(card_t));
+    return 0;
   }
-  for (i = 0; i < newDeckPos; i++) {
-    state->deck[player][i] = newDeck[i];
-    state->deckCount[player]++;
+
+  /* Fisher-Yates over the sorted deck, written "inside out" so the sorted
+     cards come straight from the counts: card i is placed at a random
+     position at or below i and the card there moves up to i */
+  for (i = 0; i < n; i++) {
+    if (next < piles) {
+      while (counts[next] == 0)
+	next++;
+      counts[next]--;
+      sorted = next;
+    } else {
+      sorted = deck[i];
+    }
+
+    if (i == 0) {
+      deck[0] = sorted;
+      continue;
+    }
+    card = RandomBelow(rng, i+1);
+    deck[i] = deck[card];
+    deck[card] = sorted;
   }
 
   return 0;
 }
 
-int playCard(int handPos, int choice1, int choice2, int choice3, struct gameState *state) 
+static int playCardMove(int handPos, int choice1, int choice2, int choice3, struct gameState *state) 
 {	
   int card;
   int coin_bonus = 0; 		//tracks coins gain from actions
@@ -249,7 +611,7 @@ int playCard(int handPos, int choice1, int choice2, int choice3, struct gameStat
   card = handCard(handPos, state);
 	
   //check if selected card is an action
-  if ( card < adventurer || card > treasure_map )
+  if ( card < curse || card >= cardCount || !(cards[card].types & CARD_ACTION) )
     {
       return -1;
     }
@@ -261,6 +623,7 @@ int playCard(int handPos, int choice1, int choice2, int choice3, struct gameStat
     }
 	
   //reduce number of actions
+  KEEP(state->numActions);
   state->numActions--;
 
   //update coins (Treasure cards may be added with card draws)
@@ -269,7 +632,7 @@ int playCard(int handPos, int choice1, int choice2, int choice3, struct gameStat
   return 0;
 }
 
-int buyCard(int supplyPos, struct gameState *state) {
+static int buyCardMove(int supplyPos, struct gameState *state) {
   int who;
   if (DEBUG){
     printf("Entering buyCard...\n");
@@ -292,6 +655,9 @@ int buyCard(int supplyPos, struct gameState *state) {
       printf("You do not have enough money to buy that. You have %d coins.\n", state->coins);
     return -1;
   } else {
+    KEEP(state->phase);
+    KEEP(state->coins);
+    KEEP(state->numBuys);
     state->phase=1;
     //state->supplyCount[supplyPos]--;
     gainCard(supplyPos, state, 0, who); //card goes in discard, this might be wrong.. (2 means goes into hand, 0 goes into discard)
@@ -314,50 +680,91 @@ int numHandCards(struct gameState *state) {
 
 int handCard(int handPos, struct gameState *state) {
   int currentPlayer = whoseTurn(state);
-  return state->hand[currentPlayer][handPos];
+  return pileCard(state->hand[currentPlayer][handPos], state);
 }
 
 int supplyCount(int card, struct gameState *state) {
-  return state->supplyCount[card];
+  int pile = supplyPile(card, state);
+
+  if (pile < 0)
+    return -1;
+  return state->pileCount[pile];
 }
 
-int fullDeckCount(int player, int card, struct gameState *state) {
-  int i;
-  int count = 0;
+int supplyPile(int card, struct gameState *state) {
+  int low = gold + 1;
+  int high = state->numPiles - 1;
+  int mid;
 
-  for (i = 0; i < state->deckCount[player]; i++)
+  //the base cards are always the first piles, and the kingdom piles
+  //after them are in card order
+  if (card >= curse && card <= gold)
+    return card;
+  while (low <= high)
     {
-      if (state->deck[player][i] == card) count++;
+      mid = (low + high) / 2;
+      if (state->supplyCard[mid] == card)
+	return mid;
+      if (state->supplyCard[mid] < card)
+	low = mid + 1;
+      else
+	high = mid - 1;
     }
+  return -1;
+}
 
-  for (i = 0; i < state->handCount[player]; i++)
-    {
-      if (state->hand[player][i] == card) count++;
-    }
+int pileCard(int pile, struct gameState *state) {
+  if (pile < 0 || pile >= state->numPiles || pile >= MAX_SUPPLY)
+    return -1;
+  return state->supplyCard[pile];
+}
 
-  for (i = 0; i < state->discardCount[player]; i++)
-    {
-      if (state->discard[player][i] == card) count++;
-    }
+int fullDeckCount(int player, int card, struct gameState *state) {
+  int pile = supplyPile(card, state);
 
-  return count;
+  if (pile < 0)
+    return 0;
+  return state->ownedCount[player][pile];
 }
 
 int whoseTurn(struct gameState *state) {
   return state->whoseTurn;
 }
 
-int endTurn(struct gameState *state) {
-  int k;
+double gameRandom(struct gameState *state) {
+  KEEP(state->rng);
+  return RandomStream(&state->rng);
+}
+
+static int endTurnMove(struct gameState *state) {
   int i;
   int currentPlayer = whoseTurn(state);
+  struct undoLog *log = state->undo;
+  int count = state->handCount[currentPlayer];
   
+  //the hand goes onto the discard, which changes only these
+  keep(state, state->hand[currentPlayer], count * sizeof(card_t));
+  keep(state, state->discard[currentPlayer] + state->discardCount[currentPlayer], count * sizeof(card_t));
+  KEEP(state->handCount[currentPlayer]);
+  KEEP(state->discardCount[currentPlayer]);
+  KEEP(state->handCoins[currentPlayer]);
+  KEEP(state->pileHash[currentPlayer]);
+  state->undo = NULL;
+
   //Discard hand
   for (i = 0; i < state->handCount[currentPlayer]; i++){
+    countHand(currentPlayer, state->hand[currentPlayer][i], -1, state);
+    hashCard(&state->pileHash[currentPlayer], HASH_PILE(currentPlayer, HASH_DISCARD), state->hand[currentPlayer][i], 1);
     state->discard[currentPlayer][state->discardCount[currentPlayer]++] = state->hand[currentPlayer][i];//Discard
     state->hand[currentPlayer][i] = -1;//Set card to -1
   }
   state->handCount[currentPlayer] = 0;//Reset hand count
+  state->handCoins[currentPlayer] = 0;
+  state->undo = log;
+
+  //outpostPlayed through numBuys
+  keep(state, &state->outpostPlayed, offsetof(struct gameState, handCount) -
+       offsetof(struct gameState, outpostPlayed));
     
   //Code for determining the player
   if (currentPlayer < (state->numPlayers - 1)){ 
@@ -372,14 +779,24 @@ int endTurn(struct gameState *state) {
   state->numActions = 1;
   state->coins = 0;
   state->numBuys = 1;
+  KEEP(state->hash);
+  KEEP(state->playedCardCount);
+  for (i = 0; i < state->playedCardCount; i++){
+    hashCard(&state->hash, HASH_PLAYED, state->playedCards[i], -1);
+  }
   state->playedCardCount = 0;
+  //anything still in the next player's hand is dropped
+  for (i = 0; i < state->handCount[state->whoseTurn]; i++){
+    countCard(state->whoseTurn, state->hand[state->whoseTurn][i], -1, state);
+    countHand(state->whoseTurn, state->hand[state->whoseTurn][i], -1, state);
+  }
+  KEEP(state->handCount[state->whoseTurn]);
+  KEEP(state->handCoins[state->whoseTurn]);
   state->handCount[state->whoseTurn] = 0;
+  state->handCoins[state->whoseTurn] = 0;
 
-  //int k; move to top
   //Next player draws hand
-  for (k = 0; k < 5; k++){
-    drawCard(state->whoseTurn, state);//Draw a card
-  }
+  drawCards(state->whoseTurn, 5, state);
 
   //Update money
   updateCoins(state->whoseTurn, state , 0);
@@ -387,71 +804,97 @@ int endTurn(struct gameState *state) {
   return 0;
 }
 
-int isGameOver(struct gameState *state) {
-  int i;
-  int j;
-	
-  //if stack of Province cards is empty, the game ends
-  if (state->supplyCount[province] == 0)
-    {
-      return 1;
-    }
+int recordUndo(struct gameState *state) {
+  struct undoLog *log = state->undo;
+  struct undoEntry mark = {0, 0};
 
-  //if three supply pile are at 0, the game ends
-  j = 0;
-  for (i = 0; i < 25; i++)
-    {
-      if (state->supplyCount[i] == 0)
-	{
-	  j++;
-	}
-    }
-  if ( j >= 3)
-    {
-      return 1;
-    }
+  if (log == NULL)
+    return 0;
+  if (log->overflow || growUndo(log, sizeof(mark)) < 0)
+    return -1;
 
+  memcpy(log->buf + log->used, &mark, sizeof(mark));
+  log->used += sizeof(mark);
+  log->moves++;
   return 0;
 }
 
-int scoreFor (int player, struct gameState *state) {
+int undoMove(struct gameState *state) {
+  struct undoLog *log = state->undo;
+  struct undoEntry entry;
 
-  int i;
-  int score = 0;
-  //score from hand
-  for (i = 0; i < state->handCount[player]; i++)
-    {
-      if (state->hand[player][i] == curse) { score = score - 1; };
-      if (state->hand[player][i] == estate) { score = score + 1; };
-      if (state->hand[player][i] == duchy) { score = score + 3; };
-      if (state->hand[player][i] == province) { score = score + 6; };
-      if (state->hand[player][i] == great_hall) { score = score + 1; };
-      if (state->hand[player][i] == gardens) { score = score + ( fullDeckCount(player, 0, state) / 10 ); };
-    }
+  if (log == NULL || log->moves < 1)
+    return -1;
 
-  //score from discard
-  for (i = 0; i < state->discardCount[player]; i++)
+  //newest first, so a field noted twice ends up with its oldest value
+  while (log->used > 0)
     {
-      if (state->discard[player][i] == curse) { score = score - 1; };
-      if (state->discard[player][i] == estate) { score = score + 1; };
-      if (state->discard[player][i] == duchy) { score = score + 3; };
-      if (state->discard[player][i] == province) { score = score + 6; };
-      if (state->discard[player][i] == great_hall) { score = score + 1; };
-      if (state->discard[player][i] == gardens) { score = score + ( fullDeckCount(player, 0, state) / 10 ); };
+      log->used -= sizeof(entry);
+      memcpy(&entry, log->buf + log->used, sizeof(entry));
+      if (entry.size == 0)
+	break;
+      log->used -= entry.size;
+      memcpy((unsigned char *) state + entry.offset, log->buf + log->used, entry.size);
     }
+  log->moves--;
 
-  //score from deck
-  for (i = 0; i < state->discardCount[player]; i++)
-    {
-      if (state->deck[player][i] == curse) { score = score - 1; };
-      if (state->deck[player][i] == estate) { score = score + 1; };
-      if (state->deck[player][i] == duchy) { score = score + 3; };
-      if (state->deck[player][i] == province) { score = score + 6; };
-      if (state->deck[player][i] == great_hall) { score = score + 1; };
-      if (state->deck[player][i] == gardens) { score = score + ( fullDeckCount(player, 0, state) / 10 ); };
-    }
+  return 0;
+}
+
+void freeUndoLog(struct undoLog *log) {
+  free(log->buf);
+  memset(log, 0, sizeof(struct undoLog));
+}
+
+//a move that fails is undone, so it leaves nothing half done behind
+static int finishUndo(struct gameState *state, int result) {
+  if (state->undo != NULL && result < 0)
+    undoMove(state);
+  return result;
+}
+
+int playCard(int handPos, int choice1, int choice2, int choice3, struct gameState *state) {
+  int result;
+
+  COUNT(COUNT_PLAY_CARD);
+  recordUndo(state);
+  result = finishUndo(state, playCardMove(handPos, choice1, choice2, choice3, state));
+  if (result < 0)
+    COUNT(COUNT_PLAY_CARD_FAILED);
+  return result;
+}
+
+int buyCard(int supplyPos, struct gameState *state) {
+  int result;
+
+  COUNT(COUNT_BUY_CARD);
+  recordUndo(state);
+  result = finishUndo(state, buyCardMove(supplyPos, state));
+  if (result < 0)
+    COUNT(COUNT_BUY_CARD_FAILED);
+  return result;
+}
+
+int endTurn(struct gameState *state) {
+  COUNT(COUNT_END_TURN);
+  recordUndo(state);
+  return finishUndo(state, endTurnMove(state));
+}
+
+int isGameOver(struct gameState *state) {
+  COUNT(COUNT_IS_GAME_OVER);
+  //the game ends when the Province pile or any three supply piles are
+  //empty; emptyPiles counts every pile, Provinces included
+  return supplyCount(province, state) == 0 || state->emptyPiles >= 3;
+}
 
-  return score;
+int scoreFor (int player, struct gameState *state) {
+  COUNT(COUNT_SCORE_FOR);
+  if (player < 0 || player >= state->numPlayers)
+    return -9999;
+
+  return state->victoryPoints[player]
+    + fullDeckCount(player, gardens, state) * (state->ownedTotal[player] / 10);
 }
 
 int getWinners(int players[MAX_PLAYERS], struct gameState *state) {
@@ -522,59 +965,88 @@ int getWinners(int players[MAX_PLAYERS], struct gameState *state) {
   return 0;
 }
 
-int drawCard(int player, struct gameState *state)
-{	int count;
-  int deckCounter;
-  if (state->deckCount[player] <= 0){//Deck is empty
-    
-    //Step 1 Shuffle the discard pile back into a deck
-    int i;
-    //Move discard to deck
-    for (i = 0; i < state->discardCount[player];i++){
-      state->deck[player][i] = state->discard[player][i];
-      state->discard[player][i] = -1;
-    }
+//the deck is empty: the discard becomes the deck and is shuffled
+static void reshuffleDiscard(int player, struct gameState *state) {
+  int i;
 
-    state->deckCount[player] = state->discardCount[player];
-    state->discardCount[player] = 0;//Reset discard
+  COUNT(COUNT_RESHUFFLE);
 
-    //Shufffle the deck
-    shuffle(player, state);//Shuffle the deck up and make it so that we can draw
-   
-    if (DEBUG){//Debug statements
-      printf("Deck count now: %d\n", state->deckCount[player]);
-    }
-    
-    state->discardCount[player] = 0;
+  keep(state, state->deck[player], state->discardCount[player] * sizeof(card_t));
+  keep(state, state->discard[player], state->discardCount[player] * sizeof(card_t));
+  KEEP(state->deckCount[player]);
+  KEEP(state->discardCount[player]);
+  KEEP(state->pileHash[player]);
 
-    //Step 2 Draw Card
-    count = state->handCount[player];//Get current player's hand count
-    
-    if (DEBUG){//Debug statements
-      printf("Current hand count: %d\n", count);
-    }
-    
-    deckCounter = state->deckCount[player];//Create a holder for the deck count
+  //Move discard to deck
+  for (i = 0; i < state->discardCount[player];i++){
+    hashCard(&state->pileHash[player], HASH_PILE(player, HASH_DISCARD), state->discard[player][i], -1);
+    hashCard(&state->pileHash[player], HASH_PILE(player, HASH_DECK), state->discard[player][i], 1);
+    state->deck[player][i] = state->discard[player][i];
+    state->discard[player][i] = -1;
+  }
 
-    if (deckCounter == 0)
-      return -1;
+  state->deckCount[player] = state->discardCount[player];
+  state->discardCount[player] = 0;//Reset discard
+
+  //Shufffle the deck
+  shuffle(player, state);//Shuffle the deck up and make it so that we can draw
 
-    state->hand[player][count] = state->deck[player][deckCounter - 1];//Add card to hand
-    state->deckCount[player]--;
-    state->handCount[player]++;//Increment hand count
+  if (DEBUG){//Debug statements
+    printf("Deck count now: %d\n", state->deckCount[player]);
   }
+}
 
-  else{
-    int count = state->handCount[player];//Get current hand count for player
-    int deckCounter;
-    if (DEBUG){//Debug statements
-      printf("Current hand count: %d\n", count);
+int drawCard(int player, struct gameState *state)
+{
+  return drawCards(player, 1, state);
+}
+
+int drawCards(int player, int n, struct gameState *state)
+{
+  card_t *deck = state->deck[player];
+  card_t *hand = state->hand[player];
+  struct undoLog *log = state->undo;
+  int run, first, count, card, i;
+
+  COUNT(COUNT_DRAW_CALL);
+  while (n > 0){
+    if (state->deckCount[player] <= 0){//Deck is empty
+      reshuffleDiscard(player, state);
+      if (state->deckCount[player] == 0)
+	return -1;
     }
 
-    deckCounter = state->deckCount[player];//Create holder for the deck count
-    state->hand[player][count] = state->deck[player][deckCounter - 1];//Add card to the hand
-    state->deckCount[player]--;
-    state->handCount[player]++;//Increment hand count
+    //take as much as is wanted off the top of the deck in one copy.
+    //The top card is the last one, so the run lands in the hand in the
+    //reverse of the order it was drawn.  Legacy games put it back in
+    //drawn order, since their discards, and so their shuffles, follow
+    //the order of the hand
+    run = n < state->deckCount[player] ? n : state->deckCount[player];
+    first = state->deckCount[player] - run;
+    count = state->handCount[player];
+    keep(state, hand + count, run * sizeof(card_t));
+    KEEP(state->deckCount[player]);
+    KEEP(state->handCount[player]);
+    KEEP(state->handCoins[player]);
+    KEEP(state->pileHash[player]);
+    state->undo = NULL;
+    memcpy(hand + count, deck + first, run * sizeof(card_t));
+    if (state->options & GAME_LEGACY_SHUFFLE){
+      for (i = 0; i < run / 2; i++){
+	card = hand[count + i];
+	hand[count + i] = hand[count + run - 1 - i];
+	hand[count + run - 1 - i] = card;
+      }
+    }
+    for (i = count; i < count + run; i++){
+      countHand(player, hand[i], 1, state);
+      hashCard(&state->pileHash[player], HASH_PILE(player, HASH_DECK), hand[i], -1);
+    }
+    state->deckCount[player] -= run;
+    state->handCount[player] += run;
+    state->undo = log;
+    n -= run;
+    COUNT_ADD(COUNT_CARDS_DRAWN, run);
   }
 
   return 0;
@@ -582,659 +1054,784 @@ int drawCard(int player, struct gameState *state)
 
 int getCost(int cardNumber)
 {
-  switch( cardNumber ) 
-    {
-    case curse:
-      return 0;
-    case estate:
-      return 2;
-    case duchy:
-      return 5;
-    case province:
-      return 8;
-    case copper:
-      return 0;
-    case silver:
-      return 3;
-    case gold:
-      return 6;
-    case adventurer:
-      return 6;
-    case council_room:
-      return 5;
-    case feast:
-      return 4;
-    case gardens:
-      return 4;
-    case mine:
-      return 5;
-    case remodel:
-      return 4;
-    case smithy:
-      return 4;
-    case village:
-      return 3;
-    case baron:
-      return 4;
-    case great_hall:
-      return 3;
-    case minion:
-      return 5;
-    case steward:
-      return 3;
-    case tribute:
-      return 5;
-    case ambassador:
-      return 3;
-    case cutpurse:
-      return 4;
-    case embargo: 
-      return 2;
-    case outpost:
-      return 5;
-    case salvager:
-      return 4;
-    case sea_hag:
-      return 4;
-    case treasure_map:
-      return 4;
-    }
-	
-  return -1;
+  if (cardNumber < curse || cardNumber >= cardCount)
+    return -1;
+  return cards[cardNumber].cost;
 }
 
-int cardEffect(int card, int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+const struct cardInfo *getCardInfo(int card)
+{
+  if (card < curse || card >= cardCount)
+    return NULL;
+  return &cards[card];
+}
+
+int addCard(const struct cardInfo *info)
+{
+  if (cardsFrozen || cardCount >= MAX_CARDS)
+    return -1;
+
+  cards[cardCount] = *info;
+  if ((info->types & CARD_ACTION) && info->effect == NULL)
+    cards[cardCount].effect = vanillaEffect;
+  return cardCount++;
+}
+
+int numCards(void)
+{
+  return cardCount;
+}
+
+//an added card that just gives +cards, +actions, +buys and +coins
+static int vanillaEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
 {
-  int i;
-  int j;
-  int k;
-  int x;
-  int index;
   int currentPlayer = whoseTurn(state);
-  int nextPlayer = currentPlayer + 1;
+  const struct cardInfo *info = &cards[handCard(handPos, state)];
 
-  int tributeRevealedCards[2] = {-1, -1};
-  int temphand[MAX_HAND];// moved above the if statement
-  int drawntreasure=0;
+  //playCard sets coins to the hand's treasure plus bonus, so carry over
+  //what earlier plays this turn added
+  *bonus = state->coins - state->handCoins[currentPlayer] + info->plusCoins;
+
+  drawCards(currentPlayer, info->plusCards, state);
+  KEEP(state->numActions);
+  KEEP(state->numBuys);
+  state->numActions += info->plusActions;
+  state->numBuys += info->plusBuys;
+
+  //discard card from hand
+  discardCard(handPos, currentPlayer, state, 0);
+  return 0;
+}
+
+static int adventurerEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int currentPlayer = whoseTurn(state);
+  int temphand[MAX_HAND];
+  int drawntreasure = 0;
   int cardDrawn;
-  int z = 0;// this is the counter for the temp hand
-  if (nextPlayer > (state->numPlayers - 1)){
-    nextPlayer = 0;
+  int z = 0;//counter for the temp hand
+
+  while(drawntreasure<2){
+    if (state->deckCount[currentPlayer] <1){//if the deck is empty we need to shuffle discard and add to deck
+      shuffle(currentPlayer, state);
+    }
+    drawCard(currentPlayer, state);
+    cardDrawn = state->hand[currentPlayer][state->handCount[currentPlayer]-1];//top card of hand is most recently drawn card.
+    if (cardDrawn == copper || cardDrawn == silver || cardDrawn == gold)
+      drawntreasure++;
+    else{
+      temphand[z]=cardDrawn;
+      countHand(currentPlayer, cardDrawn, -1, state);
+      KEEP(state->handCount[currentPlayer]);
+      state->handCount[currentPlayer]--; //this should just remove the top card (the most recently drawn one).
+      z++;
+    }
   }
-  
-	
-  //uses switch to select card and perform actions
-  switch( card ) 
-    {
-    case adventurer:
-      while(drawntreasure<2){
-	if (state->deckCount[currentPlayer] <1){//if the deck is empty we need to shuffle discard and add to deck
-	  shuffle(currentPlayer, state);
-	}
-	drawCard(currentPlayer, state);
-	cardDrawn = state->hand[currentPlayer][state->handCount[currentPlayer]-1];//top card of hand is most recently drawn card.
-	if (cardDrawn == copper || cardDrawn == silver || cardDrawn == gold)
-	  drawntreasure++;
-	else{
-	  temphand[z]=cardDrawn;
-	  state->handCount[currentPlayer]--; //this should just remove the top card (the most recently drawn one).
-	  z++;
+  keep(state, state->discard[currentPlayer] + state->discardCount[currentPlayer], z * sizeof(card_t));
+  KEEP(state->discardCount[currentPlayer]);
+  KEEP(state->pileHash[currentPlayer]);
+  while(z-1>=0){
+    hashCard(&state->pileHash[currentPlayer], HASH_PILE(currentPlayer, HASH_DISCARD), temphand[z-1], 1);
+    state->discard[currentPlayer][state->discardCount[currentPlayer]++]=temphand[z-1]; // discard all cards in play that have been drawn
+    z=z-1;
+  }
+  return 0;
+}
+
+static int councilRoomEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int currentPlayer = whoseTurn(state);
+
+  //+4 Cards
+  drawCards(currentPlayer, 4, state);
+
+  //+1 Buy
+  KEEP(state->numBuys);
+  state->numBuys++;
+
+  //Each other player draws a card
+  for (i = 0; i < state->numPlayers; i++)
+    {
+      if ( i != currentPlayer )
+	{
+	  drawCard(i, state);
 	}
+    }
+
+  //put played card in played card pile
+  discardCard(handPos, currentPlayer, state, 0);
+
+  return 0;
+}
+
+static int feastEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int x;
+  int currentPlayer = whoseTurn(state);
+  int temphand[MAX_HAND];
+
+  //gain card with cost up to 5
+  //Backup hand
+  keep(state, state->hand[currentPlayer], (state->handCount[currentPlayer] + 1) * sizeof(card_t));
+  for (i = 0; i <= state->handCount[currentPlayer]; i++){
+    temphand[i] = state->hand[currentPlayer][i];//Backup card
+    state->hand[currentPlayer][i] = -1;//Set to nothing
+  }
+  //Backup hand
+
+  //Update Coins for Buy (the backed up hand is worth nothing)
+  KEEP(state->coins);
+  state->coins = 5;
+  x = 1;//Condition to loop on
+  while( x == 1) {//Buy one card
+    if (supplyCount(choice1, state) <= 0){
+      if (DEBUG)
+	printf("None of that card left, sorry!\n");
+
+      if (DEBUG){
+	printf("Cards Left: %d\n", supplyCount(choice1, state));
       }
-      while(z-1>=0){
-	state->discard[currentPlayer][state->discardCount[currentPlayer]++]=temphand[z-1]; // discard all cards in play that have been drawn
-	z=z-1;
+    }
+    else if (state->coins < getCost(choice1)){
+      printf("That card is too expensive!\n");
+
+      if (DEBUG){
+	printf("Coins: %d < %d\n", state->coins, getCost(choice1));
       }
-      return 0;
-			
-    case council_room:
-      //+4 Cards
-      for (i = 0; i < 4; i++)
-	{
-	  drawCard(currentPlayer, state);
-	}
-			
-      //+1 Buy
-      state->numBuys++;
-			
-      //Each other player draws a card
-      for (i = 0; i < state->numPlayers; i++)
-	{
-	  if ( i != currentPlayer )
-	    {
-	      drawCard(i, state);
-	    }
-	}
-			
-      //put played card in played card pile
-      discardCard(handPos, currentPlayer, state, 0);
-			
-      return 0;
-			
-    case feast:
-      //gain card with cost up to 5
-      //Backup hand
-      for (i = 0; i <= state->handCount[currentPlayer]; i++){
-	temphand[i] = state->hand[currentPlayer][i];//Backup card
-	state->hand[currentPlayer][i] = -1;//Set to nothing
+    }
+    else{
+
+      if (DEBUG){
+	printf("Deck Count: %d\n", state->handCount[currentPlayer] + state->deckCount[currentPlayer] + state->discardCount[currentPlayer]);
       }
-      //Backup hand
-
-      //Update Coins for Buy
-      updateCoins(currentPlayer, state, 5);
-      x = 1;//Condition to loop on
-      while( x == 1) {//Buy one card
-	if (supplyCount(choice1, state) <= 0){
-	  if (DEBUG)
-	    printf("None of that card left, sorry!\n");
-
-	  if (DEBUG){
-	    printf("Cards Left: %d\n", supplyCount(choice1, state));
-	  }
-	}
-	else if (state->coins < getCost(choice1)){
-	  printf("That card is too expensive!\n");
 
-	  if (DEBUG){
-	    printf("Coins: %d < %d\n", state->coins, getCost(choice1));
-	  }
-	}
-	else{
+      gainCard(choice1, state, 0, currentPlayer);//Gain the card
+      x = 0;//No more buying cards
 
-	  if (DEBUG){
-	    printf("Deck Count: %d\n", state->handCount[currentPlayer] + state->deckCount[currentPlayer] + state->discardCount[currentPlayer]);
-	  }
+      if (DEBUG){
+	printf("Deck Count: %d\n", state->handCount[currentPlayer] + state->deckCount[currentPlayer] + state->discardCount[currentPlayer]);
+      }
 
-	  gainCard(choice1, state, 0, currentPlayer);//Gain the card
-	  x = 0;//No more buying cards
+    }
+  }     
 
-	  if (DEBUG){
-	    printf("Deck Count: %d\n", state->handCount[currentPlayer] + state->deckCount[currentPlayer] + state->discardCount[currentPlayer]);
-	  }
+  //Reset Hand
+  for (i = 0; i <= state->handCount[currentPlayer]; i++){
+    state->hand[currentPlayer][i] = temphand[i];
+    temphand[i] = -1;
+  }
+  //Reset Hand
 
-	}
-      }     
+  return 0;
+}
 
-      //Reset Hand
-      for (i = 0; i <= state->handCount[currentPlayer]; i++){
-	state->hand[currentPlayer][i] = temphand[i];
-	temphand[i] = -1;
-      }
-      //Reset Hand
-      			
-      return 0;
-			
-    case gardens:
+static int mineEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int j;
+  int currentPlayer = whoseTurn(state);
+
+  j = state->hand[currentPlayer][choice1];  //store card we will trash
+
+  if (handCard(choice1, state) < copper || handCard(choice1, state) > gold)
+    {
       return -1;
-			
-    case mine:
-      j = state->hand[currentPlayer][choice1];  //store card we will trash
+    }
 
-      if (state->hand[currentPlayer][choice1] < copper || state->hand[currentPlayer][choice1] > gold)
-	{
-	  return -1;
-	}
-		
-      if (choice2 > treasure_map || choice2 < curse)
-	{
-	  return -1;
-	}
+  if (choice2 >= cardCount || choice2 < curse)
+    {
+      return -1;
+    }
 
-      if ( (getCost(state->hand[currentPlayer][choice1]) + 3) > getCost(choice2) )
-	{
-	  return -1;
-	}
+  if ( (getCost(handCard(choice1, state)) + 3) > getCost(choice2) )
+    {
+      return -1;
+    }
 
-      gainCard(choice2, state, 2, currentPlayer);
+  gainCard(choice2, state, 2, currentPlayer);
 
-      //discard card from hand
-      discardCard(handPos, currentPlayer, state, 0);
+  //discard card from hand
+  discardCard(handPos, currentPlayer, state, 0);
 
-      //discard trashed card
-      for (i = 0; i < state->handCount[currentPlayer]; i++)
+  //discard trashed card
+  for (i = 0; i < state->handCount[currentPlayer]; i++)
+    {
+      if (state->hand[currentPlayer][i] == j)
 	{
-	  if (state->hand[currentPlayer][i] == j)
-	    {
-	      discardCard(i, currentPlayer, state, 0);			
-	      break;
-	    }
+	  discardCard(i, currentPlayer, state, 0);                  
+	  break;
 	}
-			
-      return 0;
-			
-    case remodel:
-      j = state->hand[currentPlayer][choice1];  //store card we will trash
+    }
 
-      if ( (getCost(state->hand[currentPlayer][choice1]) + 2) > getCost(choice2) )
-	{
-	  return -1;
-	}
+  return 0;
+}
 
-      gainCard(choice2, state, 0, currentPlayer);
+static int remodelEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int j;
+  int currentPlayer = whoseTurn(state);
 
-      //discard card from hand
-      discardCard(handPos, currentPlayer, state, 0);
+  j = state->hand[currentPlayer][choice1];  //store card we will trash
 
-      //discard trashed card
-      for (i = 0; i < state->handCount[currentPlayer]; i++)
-	{
-	  if (state->hand[currentPlayer][i] == j)
-	    {
-	      discardCard(i, currentPlayer, state, 0);			
-	      break;
-	    }
-	}
+  if ( (getCost(handCard(choice1, state)) + 2) > getCost(choice2) )
+    {
+      return -1;
+    }
 
+  gainCard(choice2, state, 0, currentPlayer);
 
-      return 0;
-		
-    case smithy:
-      //+3 Cards
-      for (i = 0; i < 3; i++)
+  //discard card from hand
+  discardCard(handPos, currentPlayer, state, 0);
+
+  //discard trashed card
+  for (i = 0; i < state->handCount[currentPlayer]; i++)
+    {
+      if (state->hand[currentPlayer][i] == j)
 	{
-	  drawCard(currentPlayer, state);
+	  discardCard(i, currentPlayer, state, 0);                  
+	  break;
 	}
-			
-      //discard card from hand
-      discardCard(handPos, currentPlayer, state, 0);
-      return 0;
-		
-    case village:
-      //+1 Card
-      drawCard(currentPlayer, state);
-			
-      //+2 Actions
-      state->numActions = state->numActions + 2;
-			
-      //discard played card from hand
-      discardCard(handPos, currentPlayer, state, 0);
-      return 0;
-		
-    case baron:
-      state->numBuys++;//Increase buys by 1!
-      if (choice1 > 0){//Boolean true or going to discard an estate
-	int p = 0;//Iterator for hand!
-	int card_not_discarded = 1;//Flag for discard set!
-	while(card_not_discarded){
-	  if (state->hand[currentPlayer][p] == estate){//Found an estate card!
-	    state->coins += 4;//Add 4 coins to the amount of coins
-	    state->discard[currentPlayer][state->discardCount[currentPlayer]] = state->hand[currentPlayer][p];
-	    state->discardCount[currentPlayer]++;
-	    for (;p < state->handCount[currentPlayer]; p++){
-	      state->hand[currentPlayer][p] = state->hand[currentPlayer][p+1];
-	    }
-	    state->hand[currentPlayer][state->handCount[currentPlayer]] = -1;
-	    state->handCount[currentPlayer]--;
-	    card_not_discarded = 0;//Exit the loop
-	  }
-	  else if (p > state->handCount[currentPlayer]){
-	    if(DEBUG) {
-	      printf("No estate cards in your hand, invalid choice\n");
-	      printf("Must gain an estate if there are any\n");
-	    }
-	    if (supplyCount(estate, state) > 0){
-	      gainCard(estate, state, 0, currentPlayer);
-	      state->supplyCount[estate]--;//Decrement estates
-	      if (supplyCount(estate, state) == 0){
-		isGameOver(state);
-	      }
-	    }
-	    card_not_discarded = 0;//Exit the loop
-	  }
-			    
-	  else{
-	    p++;//Next card
-	  }
+    }
+
+
+  return 0;
+}
+
+static int smithyEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int currentPlayer = whoseTurn(state);
+
+  //+3 Cards
+  drawCards(currentPlayer, 3, state);
+
+  //discard card from hand
+  discardCard(handPos, currentPlayer, state, 0);
+  return 0;
+}
+
+static int villageEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int currentPlayer = whoseTurn(state);
+
+  //+1 Card
+  drawCard(currentPlayer, state);
+
+  //+2 Actions
+  KEEP(state->numActions);
+  state->numActions = state->numActions + 2;
+
+  //discard played card from hand
+  discardCard(handPos, currentPlayer, state, 0);
+  return 0;
+}
+
+static int baronEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int currentPlayer = whoseTurn(state);
+
+  KEEP(state->numBuys);
+  state->numBuys++;//Increase buys by 1!
+  if (choice1 > 0){//Boolean true or going to discard an estate
+    int p = 0;//Iterator for hand!
+    int card_not_discarded = 1;//Flag for discard set!
+    while(card_not_discarded){
+      if (state->hand[currentPlayer][p] == estate){//Found an estate card!
+	KEEP(state->coins);
+	KEEP(state->discard[currentPlayer][state->discardCount[currentPlayer]]);
+	KEEP(state->discardCount[currentPlayer]);
+	keep(state, &state->hand[currentPlayer][p], (state->handCount[currentPlayer] - p + 1) * sizeof(card_t));
+	KEEP(state->handCount[currentPlayer]);
+	state->coins += 4;//Add 4 coins to the amount of coins
+	state->discard[currentPlayer][state->discardCount[currentPlayer]] = state->hand[currentPlayer][p];
+	state->discardCount[currentPlayer]++;
+	for (;p < state->handCount[currentPlayer]; p++){
+	  state->hand[currentPlayer][p] = state->hand[currentPlayer][p+1];
 	}
+	state->hand[currentPlayer][state->handCount[currentPlayer]] = -1;
+	state->handCount[currentPlayer]--;
+	recountCards(currentPlayer, state);
+	card_not_discarded = 0;//Exit the loop
       }
-			    
-      else{
+      else if (p > state->handCount[currentPlayer]){
+	if(DEBUG) {
+	  printf("No estate cards in your hand, invalid choice\n");
+	  printf("Must gain an estate if there are any\n");
+	}
 	if (supplyCount(estate, state) > 0){
-	  gainCard(estate, state, 0, currentPlayer);//Gain an estate
-	  state->supplyCount[estate]--;//Decrement Estates
+	  gainCard(estate, state, 0, currentPlayer);
+	  changeSupply(estate, -1, state);//Decrement estates
 	  if (supplyCount(estate, state) == 0){
 	    isGameOver(state);
 	  }
 	}
+	card_not_discarded = 0;//Exit the loop
+      }
+
+      else{
+	p++;//Next card
+      }
+    }
+  }
+
+  else{
+    if (supplyCount(estate, state) > 0){
+      gainCard(estate, state, 0, currentPlayer);//Gain an estate
+      changeSupply(estate, -1, state);//Decrement Estates
+      if (supplyCount(estate, state) == 0){
+	isGameOver(state);
       }
-	    
-      
-      return 0;
-		
-    case great_hall:
-      //+1 Card
-      drawCard(currentPlayer, state);
-			
-      //+1 Actions
-      state->numActions++;
-			
-      //discard card from hand
-      discardCard(handPos, currentPlayer, state, 0);
-      return 0;
-		
-    case minion:
-      //+1 action
-      state->numActions++;
-			
-      //discard card from hand
-      discardCard(handPos, currentPlayer, state, 0);
-			
-      if (choice1)		//+2 coins
+    }
+  }
+
+
+  return 0;
+}
+
+static int greatHallEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int currentPlayer = whoseTurn(state);
+
+  //+1 Card
+  drawCard(currentPlayer, state);
+
+  //+1 Actions
+  KEEP(state->numActions);
+  state->numActions++;
+
+  //discard card from hand
+  discardCard(handPos, currentPlayer, state, 0);
+  return 0;
+}
+
+static int minionEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int currentPlayer = whoseTurn(state);
+
+  //+1 action
+  KEEP(state->numActions);
+  state->numActions++;
+
+  //discard card from hand
+  discardCard(handPos, currentPlayer, state, 0);
+
+  if (choice1)              //+2 coins
+    {
+      KEEP(state->coins);
+      state->coins = state->coins + 2;
+    }
+
+  else if (choice2)         //discard hand, redraw 4, other players with 5+ cards discard hand and draw 4
+    {
+      //discard hand
+      while(numHandCards(state) > 0)
 	{
-	  state->coins = state->coins + 2;
+	  discardCard(handPos, currentPlayer, state, 0);
 	}
-			
-      else if (choice2)		//discard hand, redraw 4, other players with 5+ cards discard hand and draw 4
+
+      //draw 4
+      drawCards(currentPlayer, 4, state);
+
+      //other players discard hand and redraw if hand size > 4
+      for (i = 0; i < state->numPlayers; i++)
 	{
-	  //discard hand
-	  while(numHandCards(state) > 0)
-	    {
-	      discardCard(handPos, currentPlayer, state, 0);
-	    }
-				
-	  //draw 4
-	  for (i = 0; i < 4; i++)
-	    {
-	      drawCard(currentPlayer, state);
-	    }
-				
-	  //other players discard hand and redraw if hand size > 4
-	  for (i = 0; i < state->numPlayers; i++)
+	  if (i != currentPlayer)
 	    {
-	      if (i != currentPlayer)
+	      if ( state->handCount[i] > 4 )
 		{
-		  if ( state->handCount[i] > 4 )
+		  //discard hand
+		  while( state->handCount[i] > 0 )
 		    {
-		      //discard hand
-		      while( state->handCount[i] > 0 )
-			{
-			  discardCard(handPos, i, state, 0);
-			}
-							
-		      //draw 4
-		      for (j = 0; j < 4; j++)
-			{
-			  drawCard(i, state);
-			}
+		      discardCard(handPos, i, state, 0);
 		    }
+
+		  //draw 4
+		  drawCards(i, 4, state);
 		}
 	    }
-				
-	}
-      return 0;
-		
-    case steward:
-      if (choice1 == 1)
-	{
-	  //+2 cards
-	  drawCard(currentPlayer, state);
-	  drawCard(currentPlayer, state);
-	}
-      else if (choice1 == 2)
-	{
-	  //+2 coins
-	  state->coins = state->coins + 2;
-	}
-      else
-	{
-	  //trash 2 cards in hand
-	  discardCard(choice2, currentPlayer, state, 1);
-	  discardCard(choice3, currentPlayer, state, 1);
-	}
-			
-      //discard card from hand
-      discardCard(handPos, currentPlayer, state, 0);
-      return 0;
-		
-    case tribute:
-      if ((state->discardCount[nextPlayer] + state->deckCount[nextPlayer]) <= 1){
-	if (state->deckCount[nextPlayer] > 0){
-	  tributeRevealedCards[0] = state->deck[nextPlayer][state->deckCount[nextPlayer]-1];
-	  state->deckCount[nextPlayer]--;
-	}
-	else if (state->discardCount[nextPlayer] > 0){
-	  tributeRevealedCards[0] = state->discard[nextPlayer][state->discardCount[nextPlayer]-1];
-	  state->discardCount[nextPlayer]--;
 	}
-	else{
-	  //No Card to Reveal
-	  if (DEBUG){
-	    printf("No cards to reveal\n");
-	  }
-	}
-      }
-	    
-      else{
-	if (state->deckCount[nextPlayer] == 0){
-	  for (i = 0; i < state->discardCount[nextPlayer]; i++){
-	    state->deck[nextPlayer][i] = state->discard[nextPlayer][i];//Move to deck
-	    state->deckCount[nextPlayer]++;
-	    state->discard[nextPlayer][i] = -1;
-	    state->discardCount[nextPlayer]--;
-	  }
-			    
-	  shuffle(nextPlayer,state);//Shuffle the deck
-	} 
-	tributeRevealedCards[0] = state->deck[nextPlayer][state->deckCount[nextPlayer]-1];
-	state->deck[nextPlayer][state->deckCount[nextPlayer]--] = -1;
-	state->deckCount[nextPlayer]--;
-	tributeRevealedCards[1] = state->deck[nextPlayer][state->deckCount[nextPlayer]-1];
-	state->deck[nextPlayer][state->deckCount[nextPlayer]--] = -1;
-	state->deckCount[nextPlayer]--;
-      }    
-		       
-      if (tributeRevealedCards[0] == tributeRevealedCards[1]){//If we have a duplicate card, just drop one 
-	state->playedCards[state->playedCardCount] = tributeRevealedCards[1];
-	state->playedCardCount++;
-	tributeRevealedCards[1] = -1;
+
+    }
+  return 0;
+}
+
+static int stewardEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int currentPlayer = whoseTurn(state);
+
+  if (choice1 == 1)
+    {
+      //+2 cards
+      drawCards(currentPlayer, 2, state);
+    }
+  else if (choice1 == 2)
+    {
+      //+2 coins
+      KEEP(state->coins);
+      state->coins = state->coins + 2;
+    }
+  else
+    {
+      //trash 2 cards in hand
+      discardCard(choice2, currentPlayer, state, 1);
+      discardCard(choice3, currentPlayer, state, 1);
+    }
+
+  //discard card from hand
+  discardCard(handPos, currentPlayer, state, 0);
+  return 0;
+}
+
+static int tributeEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int currentPlayer = whoseTurn(state);
+  int nextPlayer = (currentPlayer + 1) % state->numPlayers;
+  int tributeRevealedCards[2] = {-1, -1};
+
+  if ((state->discardCount[nextPlayer] + state->deckCount[nextPlayer]) <= 1){
+    if (state->deckCount[nextPlayer] > 0){
+      tributeRevealedCards[0] = state->deck[nextPlayer][state->deckCount[nextPlayer]-1];
+      KEEP(state->deckCount[nextPlayer]);
+      state->deckCount[nextPlayer]--;
+    }
+    else if (state->discardCount[nextPlayer] > 0){
+      tributeRevealedCards[0] = state->discard[nextPlayer][state->discardCount[nextPlayer]-1];
+      KEEP(state->discardCount[nextPlayer]);
+      state->discardCount[nextPlayer]--;
+    }
+    else{
+      //No Card to Reveal
+      if (DEBUG){
+	printf("No cards to reveal\n");
       }
+    }
+  }
 
-      for (i = 0; i <= 2; i ++){
-	if (tributeRevealedCards[i] == copper || tributeRevealedCards[i] == silver || tributeRevealedCards[i] == gold){//Treasure cards
-	  state->coins += 2;
-	}
-		    
-	else if (tributeRevealedCards[i] == estate || tributeRevealedCards[i] == duchy || tributeRevealedCards[i] == province || tributeRevealedCards[i] == gardens || tributeRevealedCards[i] == great_hall){//Victory Card Found
-	  drawCard(currentPlayer, state);
-	  drawCard(currentPlayer, state);
-	}
-	else{//Action Card
-	  state->numActions = state->numActions + 2;
-	}
+  else{
+    if (state->deckCount[nextPlayer] == 0){
+      keep(state, state->deck[nextPlayer], state->discardCount[nextPlayer] * sizeof(card_t));
+      keep(state, state->discard[nextPlayer], state->discardCount[nextPlayer] * sizeof(card_t));
+      KEEP(state->deckCount[nextPlayer]);
+      KEEP(state->discardCount[nextPlayer]);
+      for (i = 0; i < state->discardCount[nextPlayer]; i++){
+	state->deck[nextPlayer][i] = state->discard[nextPlayer][i];//Move to deck
+	state->deckCount[nextPlayer]++;
+	state->discard[nextPlayer][i] = -1;
+	state->discardCount[nextPlayer]--;
       }
-	    
-      return 0;
-		
-    case ambassador:
-      j = 0;		//used to check if player has enough cards to discard
 
-      if (choice2 > 2 || choice2 < 0)
-	{
-	  return -1;				
-	}
+      shuffle(nextPlayer,state);//Shuffle the deck
+    } 
+    KEEP(state->deckCount[nextPlayer]);
+    tributeRevealedCards[0] = state->deck[nextPlayer][state->deckCount[nextPlayer]-1];
+    KEEP(state->deck[nextPlayer][state->deckCount[nextPlayer]]);
+    state->deck[nextPlayer][state->deckCount[nextPlayer]--] = -1;
+    state->deckCount[nextPlayer]--;
+    tributeRevealedCards[1] = state->deck[nextPlayer][state->deckCount[nextPlayer]-1];
+    KEEP(state->deck[nextPlayer][state->deckCount[nextPlayer]]);
+    state->deck[nextPlayer][state->deckCount[nextPlayer]--] = -1;
+    state->deckCount[nextPlayer]--;
+  }    
+  recountCards(nextPlayer, state);
+
+  if (tributeRevealedCards[0] == tributeRevealedCards[1]){//If we have a duplicate card, just drop one 
+    KEEP(state->playedCards[state->playedCardCount]);
+    KEEP(state->playedCardCount);
+    KEEP(state->hash);
+    state->playedCards[state->playedCardCount] = tributeRevealedCards[1];
+    state->playedCardCount++;
+    hashCard(&state->hash, HASH_PLAYED, tributeRevealedCards[1], 1);
+    tributeRevealedCards[1] = -1;
+  }
 
-      if (choice1 == handPos)
-	{
-	  return -1;
-	}
+  for (i = 0; i < 2; i ++){
+    tributeRevealedCards[i] = pileCard(tributeRevealedCards[i], state);
+    if (tributeRevealedCards[i] == copper || tributeRevealedCards[i] == silver || tributeRevealedCards[i] == gold){//Treasure cards
+      KEEP(state->coins);
+      state->coins += 2;
+    }
 
-      for (i = 0; i < state->handCount[currentPlayer]; i++)
+    else if (tributeRevealedCards[i] == estate || tributeRevealedCards[i] == duchy || tributeRevealedCards[i] == province || tributeRevealedCards[i] == gardens || tributeRevealedCards[i] == great_hall){//Victory Card Found
+      drawCards(currentPlayer, 2, state);
+    }
+    else{//Action Card
+      KEEP(state->numActions);
+      state->numActions = state->numActions + 2;
+    }
+  }
+
+  return 0;
+}
+
+static int ambassadorEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int j;
+  int currentPlayer = whoseTurn(state);
+
+  j = 0;            //used to check if player has enough cards to discard
+
+  if (choice2 > 2 || choice2 < 0)
+    {
+      return -1;                            
+    }
+
+  if (choice1 == handPos)
+    {
+      return -1;
+    }
+
+  for (i = 0; i < state->handCount[currentPlayer]; i++)
+    {
+      if (i != handPos && i == handCard(choice1, state) && i != choice1)
 	{
-	  if (i != handPos && i == state->hand[currentPlayer][choice1] && i != choice1)
-	    {
-	      j++;
-	    }
+	  j++;
 	}
-      if (j < choice2)
+    }
+  if (j < choice2)
+    {
+      return -1;                            
+    }
+
+  if (DEBUG) 
+    printf("Player %d reveals card number: %d\n", currentPlayer, handCard(choice1, state));
+
+  //increase supply count for choosen card by amount being discarded
+  changeSupply(handCard(choice1, state), choice2, state);
+
+  //each other player gains a copy of revealed card
+  for (i = 0; i < state->numPlayers; i++)
+    {
+      if (i != currentPlayer)
 	{
-	  return -1;				
+	  gainCard(handCard(choice1, state), state, 0, i);
 	}
+    }
 
-      if (DEBUG) 
-	printf("Player %d reveals card number: %d\n", currentPlayer, state->hand[currentPlayer][choice1]);
+  //discard played card from hand
+  discardCard(handPos, currentPlayer, state, 0);                    
 
-      //increase supply count for choosen card by amount being discarded
-      state->supplyCount[state->hand[currentPlayer][choice1]] += choice2;
-			
-      //each other player gains a copy of revealed card
-      for (i = 0; i < state->numPlayers; i++)
+  //trash copies of cards returned to supply
+  for (j = 0; j < choice2; j++)
+    {
+      for (i = 0; i < state->handCount[currentPlayer]; i++)
 	{
-	  if (i != currentPlayer)
+	  if (state->hand[currentPlayer][i] == state->hand[currentPlayer][choice1])
 	    {
-	      gainCard(state->hand[currentPlayer][choice1], state, 0, i);
+	      discardCard(i, currentPlayer, state, 1);
+	      break;
 	    }
 	}
+    }                       
+
+  return 0;
+}
 
-      //discard played card from hand
-      discardCard(handPos, currentPlayer, state, 0);			
+static int cutpurseEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int j;
+  int k;
+  int currentPlayer = whoseTurn(state);
 
-      //trash copies of cards returned to supply
-      for (j = 0; j < choice2; j++)
+  updateCoins(currentPlayer, state, 2);
+  for (i = 0; i < state->numPlayers; i++)
+    {
+      if (i != currentPlayer)
 	{
-	  for (i = 0; i < state->handCount[currentPlayer]; i++)
+	  for (j = 0; j < state->handCount[i]; j++)
 	    {
-	      if (state->hand[currentPlayer][i] == state->hand[currentPlayer][choice1])
+	      if (state->hand[i][j] == copper)
 		{
-		  discardCard(i, currentPlayer, state, 1);
+		  discardCard(j, i, state, 0);
 		  break;
 		}
-	    }
-	}			
-
-      return 0;
-		
-    case cutpurse:
-
-      updateCoins(currentPlayer, state, 2);
-      for (i = 0; i < state->numPlayers; i++)
-	{
-	  if (i != currentPlayer)
-	    {
-	      for (j = 0; j < state->handCount[i]; j++)
+	      if (j == state->handCount[i])
 		{
-		  if (state->hand[i][j] == copper)
-		    {
-		      discardCard(j, i, state, 0);
-		      break;
-		    }
-		  if (j == state->handCount[i])
+		  for (k = 0; k < state->handCount[i]; k++)
 		    {
-		      for (k = 0; k < state->handCount[i]; k++)
-			{
-			  if (DEBUG)
-			    printf("Player %d reveals card number %d\n", i, state->hand[i][k]);
-			}	
-		      break;
-		    }		
-		}
-					
+		      if (DEBUG)
+			printf("Player %d reveals card number %d\n", i, state->hand[i][k]);
+		    }       
+		  break;
+		}           
 	    }
-				
-	}				
 
-      //discard played card from hand
-      discardCard(handPos, currentPlayer, state, 0);			
+	}
+
+    }                               
 
-      return 0;
+  //discard played card from hand
+  discardCard(handPos, currentPlayer, state, 0);                    
 
-		
-    case embargo: 
-      //+2 Coins
-      state->coins = state->coins + 2;
-			
-      //see if selected pile is in play
-      if ( state->supplyCount[choice1] == -1 )
-	{
-	  return -1;
-	}
-			
-      //add embargo token to selected supply pile
-      state->embargoTokens[choice1]++;
-			
+  return 0;
+}
+
+static int embargoEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int currentPlayer = whoseTurn(state);
+
+  //+2 Coins
+  KEEP(state->coins);
+  state->coins = state->coins + 2;
+
+  //see if selected pile is in play
+  if ( supplyPile(choice1, state) == -1 )
+    {
+      return -1;
+    }
+
+  //add embargo token to selected supply pile
+  KEEP(state->embargoTokens[supplyPile(choice1, state)]);
+  KEEP(state->hash);
+  state->embargoTokens[supplyPile(choice1, state)]++;
+  hashCard(&state->hash, HASH_EMBARGO, supplyPile(choice1, state), 1);
+
+  //trash card
+  discardCard(handPos, currentPlayer, state, 1);            
+  return 0;
+}
+
+static int outpostEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int currentPlayer = whoseTurn(state);
+
+  //set outpost flag
+  KEEP(state->outpostPlayed);
+  state->outpostPlayed++;
+
+  //discard card
+  discardCard(handPos, currentPlayer, state, 0);
+  return 0;
+}
+
+static int salvagerEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int currentPlayer = whoseTurn(state);
+
+  //+1 buy
+  KEEP(state->numBuys);
+  state->numBuys++;
+
+  if (choice1)
+    {
+      //gain coins equal to trashed card
+      KEEP(state->coins);
+      state->coins = state->coins + getCost( handCard(choice1, state) );
       //trash card
-      discardCard(handPos, currentPlayer, state, 1);		
-      return 0;
-		
-    case outpost:
-      //set outpost flag
-      state->outpostPlayed++;
-			
-      //discard card
-      discardCard(handPos, currentPlayer, state, 0);
-      return 0;
-		
-    case salvager:
-      //+1 buy
-      state->numBuys++;
-			
-      if (choice1)
+      discardCard(choice1, currentPlayer, state, 1);        
+    }
+
+  //discard card
+  discardCard(handPos, currentPlayer, state, 0);
+  return 0;
+}
+
+static int seaHagEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int currentPlayer = whoseTurn(state);
+
+  for (i = 0; i < state->numPlayers; i++){
+    if (i != currentPlayer){
+      KEEP(state->discard[i][state->discardCount[i]]);
+      KEEP(state->discardCount[i]);
+      KEEP(state->deckCount[i]);
+      KEEP(state->deck[i][state->deckCount[i] - 2]);
+      state->discard[i][state->discardCount[i]] = state->deck[i][state->deckCount[i]--];                        state->deckCount[i]--;
+      state->discardCount[i]++;
+      state->deck[i][state->deckCount[i]--] = curse;//Top card now a curse
+      recountCards(i, state);
+    }
+  }
+  return 0;
+}
+
+static int treasureMapEffect(int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int i;
+  int index;
+  int currentPlayer = whoseTurn(state);
+
+  //search hand for another treasure_map
+  index = -1;
+  for (i = 0; i < state->handCount[currentPlayer]; i++)
+    {
+      if (handCard(i, state) == treasure_map && i != handPos)
 	{
-	  //gain coins equal to trashed card
-	  state->coins = state->coins + getCost( handCard(choice1, state) );
-	  //trash card
-	  discardCard(choice1, currentPlayer, state, 1);	
-	}
-			
-      //discard card
-      discardCard(handPos, currentPlayer, state, 0);
-      return 0;
-		
-    case sea_hag:
-      for (i = 0; i < state->numPlayers; i++){
-	if (i != currentPlayer){
-	  state->discard[i][state->discardCount[i]] = state->deck[i][state->deckCount[i]--];			    state->deckCount[i]--;
-	  state->discardCount[i]++;
-	  state->deck[i][state->deckCount[i]--] = curse;//Top card now a curse
+	  index = i;
+	  break;
 	}
-      }
-      return 0;
-		
-    case treasure_map:
-      //search hand for another treasure_map
-      index = -1;
-      for (i = 0; i < state->handCount[currentPlayer]; i++)
+    }
+  if (index > -1)
+    {
+      //trash both treasure cards
+      discardCard(handPos, currentPlayer, state, 1);
+      discardCard(index, currentPlayer, state, 1);
+
+      //gain 4 Gold cards
+      for (i = 0; i < 4; i++)
 	{
-	  if (state->hand[currentPlayer][i] == treasure_map && i != handPos)
-	    {
-	      index = i;
-	      break;
-	    }
+	  gainCard(gold, state, 1, currentPlayer);
 	}
-      if (index > -1)
-	{
-	  //trash both treasure cards
-	  discardCard(handPos, currentPlayer, state, 1);
-	  discardCard(index, currentPlayer, state, 1);
 
-	  //gain 4 Gold cards
-	  for (i = 0; i < 4; i++)
-	    {
-	      gainCard(gold, state, 1, currentPlayer);
-	    }
-				
-	  //return success
-	  return 1;
-	}
-			
-      //no second treasure_map found in hand
-      return -1;
+      //return success
+      return 1;
     }
-	
+
+  //no second treasure_map found in hand
   return -1;
 }
 
+int cardEffect(int card, int choice1, int choice2, int choice3, struct gameState *state, int handPos, int *bonus)
+{
+  int result;
+  COUNT_TIMER(started);
+
+  //cards without an effect (treasure, victory and Gardens) cannot be played
+  if (card < curse || card >= cardCount || cards[card].effect == NULL)
+    return -1;
+
+  result = cards[card].effect(choice1, choice2, choice3, state, handPos, bonus);
+  COUNT_EFFECT(card, started);
+  return result;
+}
+
 int discardCard(int handPos, int currentPlayer, struct gameState *state, int trashFlag)
 {
+  //played and trashed cards both leave the player's hand/deck/discard
+  //(a handPos past the end of the hand drops the last card instead)
+  if (handPos < state->handCount[currentPlayer])
+    {
+      countCard(currentPlayer, state->hand[currentPlayer][handPos], -1, state);
+      countHand(currentPlayer, state->hand[currentPlayer][handPos], -1, state);
+    }
+  else if (state->handCount[currentPlayer] > 0)
+    {
+      countCard(currentPlayer, state->hand[currentPlayer][state->handCount[currentPlayer] - 1], -1, state);
+      countHand(currentPlayer, state->hand[currentPlayer][state->handCount[currentPlayer] - 1], -1, state);
+    }
 	
   //if card is not trashed, added to Played pile 
   if (trashFlag < 1)
     {
       //add card to played pile
+      KEEP(state->playedCards[state->playedCardCount]);
+      KEEP(state->playedCardCount);
+      KEEP(state->hash);
       state->playedCards[state->playedCardCount] = state->hand[currentPlayer][handPos]; 
       state->playedCardCount++;
+      hashCard(&state->hash, HASH_PLAYED, state->hand[currentPlayer][handPos], 1);
     }
 	
   //set played card to -1
+  KEEP(state->hand[currentPlayer][handPos]);
+  KEEP(state->hand[currentPlayer][state->handCount[currentPlayer] - 1]);
+  KEEP(state->handCount[currentPlayer]);
   state->hand[currentPlayer][handPos] = -1;
 	
   //remove card from player's hand
@@ -1263,8 +1860,10 @@ int discardCard(int handPos, int currentPlayer, struct gameState *state, int tra
 
 int gainCard(int supplyPos, struct gameState *state, int toFlag, int player)
 {
-  //Note: supplyPos is enum of choosen card
-	
+  //Note: supplyPos is enum of choosen card; the piles get its supply pile
+  int pile = supplyPile(supplyPos, state);
+
+  COUNT(COUNT_GAIN_CARD);
   //check if supply pile is empty (0) or card is not used in game (-1)
   if ( supplyCount(supplyPos, state) < 1 )
     {
@@ -1278,52 +1877,46 @@ int gainCard(int supplyPos, struct gameState *state, int toFlag, int player)
 
   if (toFlag == 1)
     {
-      state->deck[ player ][ state->deckCount[player] ] = supplyPos;
+      KEEP(state->deck[player][state->deckCount[player]]);
+      KEEP(state->deckCount[player]);
+      KEEP(state->pileHash[player]);
+      state->deck[ player ][ state->deckCount[player] ] = pile;
       state->deckCount[player]++;
+      hashCard(&state->pileHash[player], HASH_PILE(player, HASH_DECK), pile, 1);
     }
   else if (toFlag == 2)
     {
-      state->hand[ player ][ state->handCount[player] ] = supplyPos;
+      KEEP(state->hand[player][state->handCount[player]]);
+      KEEP(state->handCount[player]);
+      state->hand[ player ][ state->handCount[player] ] = pile;
       state->handCount[player]++;
+      countHand(player, pile, 1, state);
     }
   else
     {
-      state->discard[player][ state->discardCount[player] ] = supplyPos;
+      KEEP(state->discard[player][state->discardCount[player]]);
+      KEEP(state->discardCount[player]);
+      KEEP(state->pileHash[player]);
+      state->discard[player][ state->discardCount[player] ] = pile;
       state->discardCount[player]++;
+      hashCard(&state->pileHash[player], HASH_PILE(player, HASH_DISCARD), pile, 1);
     }
 	
+  countCard(player, pile, 1, state);
+  COUNT_GAIN(supplyPos);
+
   //decrease number in supply pile
-  state->supplyCount[supplyPos]--;
+  changeSupply(supplyPos, -1, state);
 	 
   return 0;
 }
 
 int updateCoins(int player, struct gameState *state, int bonus)
 {
-  int i;
-	
-  //reset coin count
-  state->coins = 0;
-
-  //add coins for each Treasure card in player's hand
-  for (i = 0; i < state->handCount[player]; i++)
-    {
-      if (state->hand[player][i] == copper)
-	{
-	  state->coins += 1;
-	}
-      else if (state->hand[player][i] == silver)
-	{
-	  state->coins += 2;
-	}
-      else if (state->hand[player][i] == gold)
-	{
-	  state->coins += 3;
-	}	
-    }	
-
-  //add bonus
-  state->coins += bonus;
+  COUNT(COUNT_UPDATE_COINS);
+  //treasure in hand is kept current as cards move, so no rescan
+  KEEP(state->coins);
+  state->coins = state->handCoins[player] + bonus;
 
   return 0;
 }
@@ -1,10 +1,24 @@
 #ifndef _DOMINION_H
 #define _DOMINION_H
 
+#include "rngs.h"
+
 // Code from various sources, baseline from Kristen Bartosz
 
-#define MAX_HAND 500
-#define MAX_DECK 500
+/* Card ids: the cards below plus any added at run time with addCard
+   (dominion_helpers.h) */
+#define MAX_CARDS 512
+
+/* Supply piles in one game: the 7 base piles and up to 13 kingdom piles
+   (a 10 card kingdom with room for a few extra piles) */
+#define MAX_KINGDOM 13
+#define MAX_SUPPLY (7 + MAX_KINGDOM)
+
+/* The most cards one player can ever hold: the whole supply of a 4 player
+   game (168 base cards and at most 12 in each kingdom pile) plus every
+   starting deck (40), rounded up to 16 bytes; 368 */
+#define MAX_HAND ((168 + 12 * MAX_KINGDOM + 40 + 15) / 16 * 16)
+#define MAX_DECK MAX_HAND
 
 #define MAX_PLAYERS 4
 
@@ -52,10 +66,24 @@ enum CARD
    treasure_map
   };
 
+/* Piles hold the supply pile a card came from, not the card id, so a
+   card is one byte however many cards the pool has; -1 marks an empty
+   slot.  supplyCard (or pileCard) turns a pile back into the card.  The
+   base piles curse .. gold are always piles 0 .. 6, the same numbers as
+   their cards */
+typedef signed char card_t;
+
 struct gameState {
   int numPlayers; //number of players
-  int supplyCount[treasure_map+1];  //this is the amount of a specific type of card given a specific number.
-  int embargoTokens[treasure_map+1];
+  int options; /* GAME_* flags passed to initializeGameOpts */
+  rngStream rng; /* this game's own random stream, seeded by initializeGame */
+  rngStream deckRng[MAX_PLAYERS]; /* each player's shuffle stream under GAME_CRN */
+  int numPiles; /* supply piles in this game */
+  short supplyCard[MAX_SUPPLY]; /* the card in each pile, in card order */
+  int pileCount[MAX_SUPPLY]; /* cards left in each pile; what supplyCount[card]
+				used to hold, read it with supplyCount() */
+  int embargoTokens[MAX_SUPPLY]; /* on each pile */
+  int emptyPiles; /* supply piles at 0, kept current by every supply change */
   int outpostPlayed;
   int outpostTurn;
   int whoseTurn;
@@ -63,14 +91,41 @@ struct gameState {
   int numActions; /* Starts at 1 each turn */
   int coins; /* Use as you see fit! */
   int numBuys; /* Starts at 1 each turn */
-  int hand[MAX_PLAYERS][MAX_HAND];
   int handCount[MAX_PLAYERS];
-  int deck[MAX_PLAYERS][MAX_DECK];
   int deckCount[MAX_PLAYERS];
-  int discard[MAX_PLAYERS][MAX_DECK];
   int discardCount[MAX_PLAYERS];
-  int playedCards[MAX_DECK];
   int playedCardCount;
+  short ownedCount[MAX_PLAYERS][MAX_SUPPLY]; /* hand + deck + discard, per pile's card */
+  short ownedTotal[MAX_PLAYERS]; /* all cards in hand + deck + discard */
+  int victoryPoints[MAX_PLAYERS]; /* score not counting Gardens */
+  int handCoins[MAX_PLAYERS]; /* treasure value of each player's hand */
+  unsigned long long hash; /* supply, embargo and played part of hashGameState */
+  unsigned long long pileHash[MAX_PLAYERS]; /* each player's hand, deck and discard part */
+  struct undoLog *undo; /* NULL, or where moves record how to undo themselves */
+  /* Piles go last so copyGameState can copy the header in one block and
+     then only the occupied part of each pile */
+  card_t hand[MAX_PLAYERS][MAX_HAND];
+  card_t deck[MAX_PLAYERS][MAX_DECK];
+  card_t discard[MAX_PLAYERS][MAX_DECK];
+  card_t playedCards[MAX_DECK];
+};
+
+/* Make/unmake for search: point state->undo at a zeroed log and every
+   playCard, buyCard and endTurn opens a record, which undoMove pops.  As
+   a move runs, each field and pile slot it changes is noted just before
+   the change, so a record is a few bytes per card moved: about 100
+   bytes for a buy, 150 for a play and 200 for an end of turn in a two
+   player game.  buf grows as needed; release it with
+   freeUndoLog.  If it cannot grow, the records are dropped, overflow is
+   set and moves go on unrecorded until the caller clears it, so a move
+   never fails for want of log space.  A move that fails is undone on
+   the spot */
+struct undoLog {
+  int used;     /* bytes of buf holding records */
+  int size;     /* bytes allocated at buf */
+  int moves;    /* records in buf, newest last */
+  int overflow; /* set if buf could not grow; the records are gone */
+  unsigned char *buf;
 };
 
 /* All functions return -1 on failure, and DO NOT CHANGE GAME STATE;
@@ -81,6 +136,11 @@ struct gameState* newGame();
 int* kingdomCards(int k1, int k2, int k3, int k4, int k5, int k6, int k7,
 		  int k8, int k9, int k10);
 
+int copyGameState(struct gameState *dest, struct gameState *src);
+/* Clone src into dest for search/rollouts.  Only the occupied part of each
+   pile is copied, so slots past a pile's count are left as they were in
+   dest; use memcpy if those must match too.  dest has no undo log */
+
 int initializeGame(int numPlayers, int kingdomCards[10], int randomSeed,
 		   struct gameState *state);
 /* Responsible for initializing all supplies, and shuffling deck and
@@ -89,9 +149,27 @@ int initializeGame(int numPlayers, int kingdomCards[10], int randomSeed,
 
 Cards not in game should initialize supply position to -1 */
 
+/* Flags for initializeGameOpts, or them together */
+#define GAME_LEGACY_SHUFFLE 1 /* shuffle in the original O(n^2) order so old
+				 seeds replay the same games */
+#define GAME_FAST_RNG 2 /* SplitMix64 instead of the Lehmer generator; same
+			   seed, different (but reproducible) games */
+#define GAME_CRN 4 /* common random numbers: each player shuffles from a
+		      stream of its own, so a player's draws do not depend
+		      on what the other players do */
+
+int initializeGameOpts(int numPlayers, int kingdomCards[10], int randomSeed,
+		       int options, struct gameState *state);
+/* initializeGame with GAME_* options; initializeGame passes 0 */
+
+int initializeGameSupply(int numPlayers, const int *kingdomCards, int numKingdom,
+			 int randomSeed, int options, struct gameState *state);
+/* initializeGameOpts with numKingdom kingdom piles (0 to MAX_KINGDOM)
+   drawn from every card in the pool, added ones included */
+
 int shuffle(int player, struct gameState *state);
 /* Assumes all cards are now in deck array (or hand/played):  discard is
- empty */
+ empty.  Fisher-Yates unless the game uses GAME_LEGACY_SHUFFLE */
 
 int playCard(int handPos, int choice1, int choice2, int choice3,
 	     struct gameState *state);
@@ -107,22 +185,59 @@ int handCard(int handNum, struct gameState *state);
 /* enum value of indexed card in player's hand */
 
 int supplyCount(int card, struct gameState *state);
-/* How many of given card are left in supply */
+/* How many of given card are left in supply, -1 if it is not in this game */
+
+int supplyPile(int card, struct gameState *state);
+/* Which of the game's supply piles holds card, -1 if none does.  This is
+   what a pile stores for the card */
+
+int pileCard(int pile, struct gameState *state);
+/* The card of a supply pile, so the card a pile slot holds; -1 for an
+   empty slot (-1) or a pile not in the game */
 
 int fullDeckCount(int player, int card, struct gameState *state);
-/* Here deck = hand + discard + deck */
+/* Here deck = hand + discard + deck.  Kept up to date as cards move, so
+   this is a table lookup */
 
 int whoseTurn(struct gameState *state);
 
+double gameRandom(struct gameState *state);
+/* Next random number in (0,1) from the game's own stream.  Games never
+   share RNG state, so separate games can run on separate threads and
+   each stays reproducible from its seed */
+
 int endTurn(struct gameState *state);
 /* Must do phase C and advance to next player; do not advance whose turn
    if game is over */
 
 int isGameOver(struct gameState *state);
+/* 1 once the Province pile or any three supply piles are empty.  The
+   empty piles are counted as the supply changes, so after editing
+   pileCount by hand call rehashGameState */
+
+int undoMove(struct gameState *state);
+/* Put state back exactly as it was before its newest recorded move,
+   random streams included.  -1 if the log is empty or missing */
+
+int recordUndo(struct gameState *state);
+/* Open a record by hand, e.g. before calling gainCard or drawCard
+   directly, so undoMove comes back here.  Changes made with no record
+   open are not noted.  -1 if the log has overflowed; does nothing
+   without a log */
+
+void freeUndoLog(struct undoLog *log);
+/* Free the log's buffer and zero it, ready for reuse */
+
+unsigned long long hashGameState(struct gameState *state);
+/* 64-bit hash of the position for transposition tables: supply and
+   embargo counts, the cards (not their order) in each pile, whose turn,
+   phase, actions, buys and coins.  Kept up to date as cards move, so
+   this is a few multiplies, not a pass over the piles */
 
 int scoreFor(int player, struct gameState *state);
 /* Negative here does not mean invalid; scores may be negative,
-   -9999 means invalid input */
+   -9999 means invalid input.  Each Gardens is worth 1 point per 10 cards
+   in hand + deck + discard */
 
 int getWinners(int players[MAX_PLAYERS], struct gameState *state);
 /* Set array position of each player who won (remember ties!) to
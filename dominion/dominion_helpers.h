@@ -3,12 +3,51 @@
 
 #include "dominion.h"
 
+/* Card type bits */
+#define CARD_TREASURE 1
+#define CARD_VICTORY 2
+#define CARD_ACTION 4
+#define CARD_ATTACK 8
+
+/* One entry of the card table, which everything about a card the
+   engine needs is read from */
+struct cardInfo {
+  const char *name;
+  int cost;
+  int types;      /* CARD_* bits, none for Curse */
+  int coins;      /* a treasure's worth */
+  int vp;         /* printed victory points, Gardens is scored separately */
+  int plusCards;  /* what playing an added action card gives, see addCard */
+  int plusActions;
+  int plusBuys;
+  int plusCoins;
+  int (*effect)(int choice1, int choice2, int choice3,
+		struct gameState *state, int handPos, int *bonus);
+                  /* playing it, NULL for cards that cannot be played */
+};
+
 int drawCard(int player, struct gameState *state);
+int drawCards(int player, int n, struct gameState *state);
 int updateCoins(int player, struct gameState *state, int bonus);
 int discardCard(int handPos, int currentPlayer, struct gameState *state, 
 		int trashFlag);
 int gainCard(int supplyPos, struct gameState *state, int toFlag, int player);
 int getCost(int cardNumber);
+const struct cardInfo *getCardInfo(int card);
+/* The card's table entry, NULL for a card not in the pool */
+
+int addCard(const struct cardInfo *info);
+/* Add a card to the pool and return its id, -1 once there are MAX_CARDS.
+   An action card with no effect of its own gets +plusCards cards,
+   +plusActions actions, +plusBuys buys and +plusCoins coins.  The name
+   is not copied.  The pool is read by every game without locks, so it
+   is frozen when the first game is set up: from then on addCard
+   returns -1 */
+
+int numCards(void);
+/* Cards in the pool: ids 0 .. numCards() - 1 */
+int recountCards(int player, struct gameState *state);
+int rehashGameState(struct gameState *state);
 int cardEffect(int card, int choice1, int choice2, int choice3, 
 	       struct gameState *state, int handPos, int *bonus);
 
@@ -0,0 +1,213 @@
+/* 	Exact draw probabilities
+*/
+
+#include <string.h>
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "drawprob.h"
+
+//a player never holds more than MAX_DECK cards, so no pile drawn from
+//(not even the discard with a hand thrown on it) is bigger
+#define MAX_PILE MAX_DECK
+//coins tracked in one pile's draw, a Gold a card; a richer draw (only
+//possible with added treasure worth more) counts as MAX_COINS - 1
+#define MAX_COINS (3 * MAX_PILE + 1)
+
+//choose(n, k) for 0 <= k <= n <= MAX_PILE, row n starts at n(n+1)/2
+static double binomial[(MAX_PILE + 1) * (MAX_PILE + 2) / 2];
+static int built = 0;
+
+static double choose(int n, int k) {
+  if (k < 0 || k > n)
+    return 0;
+  return binomial[n * (n + 1) / 2 + k];
+}
+
+static int pileSize(const int *count) {
+  int card;
+  int n = 0;
+
+  for (card = curse; card < numCards(); card++)
+    n += count[card];
+  return n;
+}
+
+void initDrawProb(void) {
+  int n, k;
+
+  if (built)
+    return;
+
+  //Pascal's triangle
+  for (n = 0; n <= MAX_PILE; n++)
+    {
+      binomial[n * (n + 1) / 2] = 1;
+      binomial[n * (n + 1) / 2 + n] = 1;
+      for (k = 1; k < n; k++)
+	binomial[n * (n + 1) / 2 + k] = choose(n - 1, k - 1) + choose(n - 1, k);
+    }
+  built = 1;
+}
+
+int drawPilesOf(int player, struct gameState *state, int handDiscarded,
+		struct drawPiles *piles) {
+  int i, card;
+
+  if (player < 0 || player >= state->numPlayers)
+    return -1;
+
+  memset(piles, 0, sizeof(struct drawPiles));
+  for (i = 0; i < state->deckCount[player]; i++)
+    {
+      card = pileCard(state->deck[player][i], state);
+      if (card >= curse)
+	piles->deck[card]++;
+    }
+  for (i = 0; i < state->discardCount[player]; i++)
+    {
+      card = pileCard(state->discard[player][i], state);
+      if (card >= curse)
+	piles->discard[card]++;
+    }
+  for (i = 0; handDiscarded && i < state->handCount[player]; i++)
+    {
+      card = pileCard(state->hand[player][i], state);
+      if (card >= curse)
+	piles->discard[card]++;
+    }
+  return 0;
+}
+
+//coins a card is worth when drawn, from the card table, so treasure
+//added with addCard counts like the built-in ones
+static int coinsOf(int card) {
+  const struct cardInfo *info = getCardInfo(card);
+
+  return info != NULL && info->coins > 0 ? info->coins : 0;
+}
+
+//add to dist the ways to draw k more cards on top of coins already
+//drawn: some of each treasure in kinds[t..], the rest from the others,
+//which are worth nothing.  dist[top] collects top coins or more
+static void addDraws(const int *count, const int *kinds, int numKinds, int t,
+		     int k, int others, int coins, double ways, double *dist, int top) {
+  int x;
+
+  if (t == numKinds)
+    {
+      if (k <= others)
+	dist[coins < top ? coins : top] += ways * choose(others, k);
+      return;
+    }
+  for (x = 0; x <= count[kinds[t]] && x <= k; x++)
+    addDraws(count, kinds, numKinds, t + 1, k - x, others,
+	     coins + x * coinsOf(kinds[t]), ways * choose(count[kinds[t]], x), dist, top);
+}
+
+//dist[c] = P(k cards off one pile hold c coins) for c below size - 1,
+//dist[size - 1] = P(size - 1 or more).  Only the number of each
+//treasure drawn matters, so the sum runs over those and the rest are
+//filled from the other cards.  Returns the most coins the draw can hold
+static int pileCoins(const int *count, int k, double *dist, int size) {
+  int kinds[MAX_CARDS];
+  int numKinds = 0;
+  int others = pileSize(count);
+  double all = choose(others, k);
+  int card, c;
+  int most = 0;
+
+  for (card = curse; card < numCards(); card++)
+    {
+      if (count[card] > 0 && coinsOf(card) > 0)
+	{
+	  kinds[numKinds++] = card;
+	  others -= count[card];
+	  most += (count[card] < k ? count[card] : k) * coinsOf(card);
+	}
+    }
+
+  memset(dist, 0, size * sizeof(double));
+  addDraws(count, kinds, numKinds, 0, k, others, 0, 1, dist, size - 1);
+  for (c = 0; c < size; c++)
+    dist[c] /= all;
+  return most < size - 1 ? most : size - 1;
+}
+
+//how many of n draws come off the deck and how many off the discard
+static void splitDraw(const struct drawPiles *piles, int n, int *fromDeck, int *fromDiscard) {
+  int deck = pileSize(piles->deck);
+  int discard = pileSize(piles->discard);
+
+  *fromDeck = n < deck ? n : deck;
+  *fromDiscard = n - *fromDeck < discard ? n - *fromDeck : discard;
+}
+
+int coinDistribution(const struct drawPiles *piles, int n, double *dist, int size) {
+  double deck[MAX_COINS];
+  double discard[MAX_COINS];
+  int top = size < MAX_COINS ? size : MAX_COINS;
+  int n1, n2, most1, most2;
+  int a, b, c;
+
+  if (n < 0 || size < 1 || pileSize(piles->deck) > MAX_PILE ||
+      pileSize(piles->discard) > MAX_PILE)
+    return -1;
+  initDrawProb();
+
+  splitDraw(piles, n, &n1, &n2);
+  most1 = pileCoins(piles->deck, n1, deck, top);
+  most2 = pileCoins(piles->discard, n2, discard, top);
+
+  //the two draws are independent, so add their coins up
+  memset(dist, 0, size * sizeof(double));
+  for (a = 0; a <= most1; a++)
+    {
+      for (b = 0; b <= most2; b++)
+	{
+	  c = a + b < size - 1 ? a + b : size - 1;
+	  dist[c] += deck[a] * discard[b];
+	}
+    }
+  return 0;
+}
+
+double probCoinsAtLeast(const struct drawPiles *piles, int n, int coins) {
+  double dist[MAX_COINS];
+
+  if (coins <= 0)
+    return 1;
+  if (n < 0 || coins >= MAX_COINS)
+    return 0;
+  if (coinDistribution(piles, n, dist, coins + 1) < 0)
+    return 0;
+  return dist[coins];
+}
+
+//P(k cards off a pile of size cards, hits of them card, include x of it)
+static double hypergeometric(int size, int hits, int k, int x) {
+  return choose(hits, x) * choose(size - hits, k - x) / choose(size, k);
+}
+
+double probCardsAtLeast(const struct drawPiles *piles, int n, int card, int copies) {
+  int deck = pileSize(piles->deck);
+  int discard = pileSize(piles->discard);
+  double p = 0;
+  double tail;
+  int n1, n2, x, y;
+
+  if (copies <= 0)
+    return 1;
+  if (n < 0 || card < curse || card >= MAX_CARDS || deck > MAX_PILE || discard > MAX_PILE)
+    return 0;
+  initDrawProb();
+
+  splitDraw(piles, n, &n1, &n2);
+  for (x = 0; x <= n1 && x <= piles->deck[card]; x++)
+    {
+      tail = 0;
+      for (y = copies - x > 0 ? copies - x : 0; y <= n2 && y <= piles->discard[card]; y++)
+	tail += hypergeometric(discard, piles->discard[card], n2, y);
+      p += hypergeometric(deck, piles->deck[card], n1, x) * tail;
+    }
+  return p;
+}
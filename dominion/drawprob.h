@@ -0,0 +1,47 @@
+/* 	Exact draw probabilities
+
+	What the next cards a player draws can hold, worked out exactly
+	from how many of each card are in the deck and the discard instead
+	of by sampling.  Draws come off the deck first; if it runs out, the
+	rest come off the shuffled discard, as drawCard does.  Each part is
+	a multivariate hypergeometric draw, and the binomial coefficients
+	come from a table built once.
+*/
+
+#ifndef _DRAWPROB_H
+#define _DRAWPROB_H
+
+#include "dominion.h"
+
+struct drawPiles {
+  int deck[MAX_CARDS];     /* copies of each card left in the deck */
+  int discard[MAX_CARDS];  /* and in the discard, drawn once the deck is empty */
+};
+
+void initDrawProb(void);
+/* Build the tables.  The other functions do it on first use, but a
+   threaded program should call this before its threads start */
+
+int drawPilesOf(int player, struct gameState *state, int handDiscarded,
+		struct drawPiles *piles);
+/* Fill piles from player's deck and discard.  With handDiscarded the
+   cards in hand count as discarded, which is how they stand when the
+   hand for player's next turn is drawn */
+
+int coinDistribution(const struct drawPiles *piles, int n, double *dist, int size);
+/* dist[c] = P(the next n cards hold exactly c coins of treasure) for c
+   below size - 1, and dist[size - 1] = P(size - 1 or more).  Each card
+   is worth the coins getCardInfo gives it, so treasure added with
+   addCard counts too.  Draws past the end of both piles are not made.
+   -1 if n < 0 or size < 1 */
+
+double probCoinsAtLeast(const struct drawPiles *piles, int n, int coins);
+/* P(the next n cards hold at least coins).  With Smithy in hand,
+   probCoinsAtLeast(piles, 3, getCost(province) - state->coins) is the
+   chance of a Province after playing it; for the next turn's hand it
+   is drawPilesOf(player, state, 1, piles) and n = 5 */
+
+double probCardsAtLeast(const struct drawPiles *piles, int n, int card, int copies);
+/* P(the next n cards include at least copies of card) */
+
+#endif
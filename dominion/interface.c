@@ -8,134 +8,29 @@ Sam Heinith CS362
 #include <math.h>
 #include <assert.h>
 #include <string.h>
+#include <stdlib.h>
 #include "rngs.h"
 #include "interface.h"
 #include "dominion.h"
+#include "dominion_helpers.h"
+#include "strategy.h"
 
 
 void cardNumToName(int card, char *name){
-  switch(card){
-  case curse: strcpy(name,"Curse");
-    break;
-  case estate: strcpy(name,"Estate");
-    break;
-  case duchy: strcpy(name,"Duchy");
-    break;
-  case province: strcpy(name,"Province");
-    break;
-  case copper: strcpy(name,"Copper");
-    break;
-  case silver: strcpy(name,"Silver");
-    break;
-  case gold: strcpy(name,"Gold");
-    break;
-  case adventurer: strcpy(name,"Adventurer");
-    break;
-  case council_room: strcpy(name,"Council Room");
-    break;
-  case feast: strcpy(name,"Feast");
-    break;
-  case gardens: strcpy(name,"Gardens");
-    break;
-  case mine: strcpy(name,"Mine");
-    break;
-  case remodel: strcpy(name,"Remodel");
-    break;
-  case smithy: strcpy(name,"Smithy");
-    break;
-  case village: strcpy(name,"Village");
-    break;
-  case baron: strcpy(name,"Baron");
-    break;
-  case great_hall: strcpy(name,"Great Hall");
-    break;
-  case minion: strcpy(name,"Minion");
-    break;
-  case steward: strcpy(name,"Steward");
-    break;
-  case tribute: strcpy(name,"Tribute");
-    break;
-  case ambassador: strcpy(name,"Ambassador");
-    break;
-  case cutpurse: strcpy(name,"Cutpurse");
-    break;
-  case embargo: strcpy(name,"Embargo");
-    break;
-  case outpost: strcpy(name,"Outpost");
-    break;
-  case salvager: strcpy(name,"Salvager");
-    break;
-  case sea_hag: strcpy(name,"Sea Hag");
-    break;
-  case treasure_map: strcpy(name,"Treasure Map");
-    break;
-
-  default: strcpy(name,"?");
-  }
+  const struct cardInfo *info = getCardInfo(card);
 
+  if (info == NULL)
+    strcpy(name,"?");
+  else
+    strcpy(name, info->name);
 }
 
 
 
 int getCardCost(int card) {
-  int cost;
-  switch(card) {
-  case curse: cost = CURSE_COST;
-    break;
-  case estate: cost = ESTATE_COST;
-    break;
-  case duchy: cost = DUCHY_COST;
-    break;
-  case province: cost = PROVINCE_COST;
-    break;
-  case copper: cost = COPPER_COST;
-    break;
-  case silver: cost = SILVER_COST;
-    break;
-  case gold: cost = GOLD_COST;
-    break;
-  case adventurer: cost = ADVENTURER_COST;
-    break;
-  case council_room: cost = COUNCIL_ROOM_COST;
-    break;
-  case feast: cost = FEAST_COST;
-    break;
-  case gardens: cost = GARDEN_COST;
-    break;
-  case mine:  cost = MINE_COST;
-    break;
-  case remodel: cost = REMODEL_COST;
-    break;
-  case smithy: cost = SMITHY_COST;
-    break;
-  case village: cost = VILLAGE_COST;
-    break;
-  case baron: cost = BARON_COST;
-    break;
-  case great_hall: cost = GREAT_HALL_COST;
-    break;
-  case minion: cost = MINION_COST;
-    break;
-  case steward: cost = STEWARD_COST;
-    break;
-  case tribute: cost = TRIBUTE_COST;
-    break;
-  case ambassador: cost = AMBASSADOR_COST;
-    break;
-  case cutpurse: cost = CUTPURSE_COST;
-    break;
-  case embargo: cost = EMBARGO_COST;
-    break;
-  case outpost: cost = OUTPOST_COST;
-    break;
-  case salvager: cost = SALVAGER_COST;
-    break;
-  case sea_hag: cost = SEA_HAG_COST;
-    break;
-  case treasure_map: cost = TREASURE_MAP_COST;
-    break;
-  default: cost = ONETHOUSAND;
-  }
+  int cost = getCost(card);
+  if (cost < 0)
+    cost = ONETHOUSAND;
   return cost;
 }
 
@@ -150,7 +45,7 @@ void printHand(int player, struct gameState *game) {
   printf("Player %d's hand:\n", player);
   if(handCount > 0) printf("#  Card\n");
   for(handIndex = 0; handIndex < handCount; handIndex++) {
-    int card = game->hand[player][handIndex];
+    int card = pileCard(game->hand[player][handIndex], game);
     char name[MAX_STRING_LENGTH];
     cardNumToName(card, name);
     printf("%-2d %-13s\n", handIndex, name);
@@ -166,7 +61,7 @@ void printDeck(int player, struct gameState *game) {
   printf("Player %d's deck: \n", player);
   if(deckCount > 0) printf("#  Card\n");
   for(deckIndex = 0; deckIndex < deckCount; deckIndex++) {
-    int card = game->deck[player][deckIndex];
+    int card = pileCard(game->deck[player][deckIndex], game);
     char name[MAX_STRING_LENGTH];
     cardNumToName(card, name);
     printf("%-2d %-13s\n", deckIndex, name);
@@ -180,7 +75,7 @@ void printPlayed(int player, struct gameState *game) {
   printf("Player %d's played cards: \n", player);
   if(playedCount > 0) printf("#  Card\n");
   for(playedIndex = 0; playedIndex < playedCount; playedIndex++) {
-    int card = game->playedCards[playedIndex];
+    int card = pileCard(game->playedCards[playedIndex], game);
     char name[MAX_STRING_LENGTH];
     cardNumToName(card, name);
     printf("%-2d %-13s \n", playedIndex, name);
@@ -196,7 +91,7 @@ void printDiscard(int player, struct gameState *game) {
   printf("Player %d's discard: \n", player);
   if(discardCount > 0) printf("#  Card\n");
   for(discardIndex = 0; discardIndex < discardCount; discardIndex++) {
-    int card = game->discard[player][discardIndex];
+    int card = pileCard(game->discard[player][discardIndex], game);
     char name[MAX_STRING_LENGTH];
     cardNumToName(card, name);
     printf("%-2d %-13s \n", discardIndex, name);
@@ -208,12 +103,12 @@ void printDiscard(int player, struct gameState *game) {
 
 
 void printSupply(struct gameState *game) {
-  int cardNum, cardCost, cardCount;
+  int pile, cardNum, cardCost, cardCount;
   char name[MAX_STRING_LENGTH];
   printf("#   Card          Cost   Copies\n");
-  for(cardNum = 0; cardNum < NUM_TOTAL_K_CARDS; cardNum++){
-    cardCount = game->supplyCount[cardNum];
-    if(cardCount == -1) continue;
+  for(pile = 0; pile < game->numPiles; pile++){
+    cardNum = game->supplyCard[pile];
+    cardCount = game->pileCount[pile];
     cardNumToName(cardNum, name);
     cardCost = getCardCost(cardNum);
     printf("%-2d  %-13s %-5d  %-5d", cardNum, name, cardCost, cardCount);
@@ -276,10 +171,11 @@ void phaseNumToName(int phase, char *name) {
 
 
 int addCardToHand(int player, int card, struct gameState *game) {
-  if(card >= adventurer && card < NUM_TOTAL_K_CARDS){
+  if(card >= adventurer && supplyPile(card, game) >= 0){
     int handTop = game->handCount[player];
-    game->hand[player][handTop] = card;
+    game->hand[player][handTop] = supplyPile(card, game);
     game->handCount[player]++;
+    recountCards(player, game);
     return SUCCESS;
   } else {
     return FAILURE;
@@ -288,14 +184,19 @@ int addCardToHand(int player, int card, struct gameState *game) {
 }
 
 void selectKingdomCards(int randomSeed, int kingCards[NUM_K_CARDS]) {
+  selectKingdom(randomSeed, kingCards, NUM_K_CARDS);
+}
+
+int selectKingdom(int randomSeed, int *kingCards, int numKingdom) {
    int i, used, card, numSelected = 0;
-   SelectStream(1);
-	PutSeed((long)randomSeed);
+   rngStream rng;
+	PutSeedStream(&rng, (long)randomSeed);
  
+  if(numKingdom < 0 || numKingdom > numCards() - adventurer) return FAILURE;
 	
-  while(numSelected < NUM_K_CARDS) {
+  while(numSelected < numKingdom) {
     used = FALSE;
-    card = floor(Random() * NUM_TOTAL_K_CARDS);
+    card = floor(RandomStream(&rng) * numCards());
     if(card < adventurer) continue;
     for(i = 0; i < numSelected; i++) {
       if(kingCards[i] == card) {
@@ -307,6 +208,62 @@ void selectKingdomCards(int randomSeed, int kingCards[NUM_K_CARDS]) {
     kingCards[numSelected] = card;
     numSelected++;
   }
+  return SUCCESS;
+}
+
+
+//CARD_* bits for a list like "action|attack", -1 for an unknown type
+static int parseTypes(char *list) {
+  char *word;
+  int types = 0;
+
+  for(word = strtok(list, "| \t"); word != NULL; word = strtok(NULL, "| \t")) {
+    if(strcmp(word, "treasure") == 0) types |= CARD_TREASURE;
+    else if(strcmp(word, "victory") == 0) types |= CARD_VICTORY;
+    else if(strcmp(word, "action") == 0) types |= CARD_ACTION;
+    else if(strcmp(word, "attack") == 0) types |= CARD_ATTACK;
+    else return FAILURE;
+  }
+  return types;
+}
+
+int loadCardPool(const char *path) {
+  FILE *file = fopen(path, "r");
+  char line[256];
+  char name[MAX_STRING_LENGTH], types[64];
+  struct cardInfo info;
+  char *copy;
+  int added = 0;
+
+  if(file == NULL) return FAILURE;
+
+  while(fgets(line, sizeof(line), file) != NULL) {
+    if(sscanf(line, " %c", name) < 1 || name[0] == '#') continue;
+
+    memset(&info, 0, sizeof(info));
+    if(sscanf(line, " %31[^,], %d, %63[^,], %d, %d, %d, %d, %d, %d", name, &info.cost,
+	      types, &info.coins, &info.vp, &info.plusCards, &info.plusActions,
+	      &info.plusBuys, &info.plusCoins) != 9 ||
+       (info.types = parseTypes(types)) < 0 || info.cost < 0) {
+      fclose(file);
+      return FAILURE;
+    }
+
+    //the pool keeps the name, so it needs a copy of its own
+    copy = malloc(strlen(name) + 1);
+    if(copy == NULL) break;
+    strcpy(copy, name);
+    info.name = copy;
+    if(addCard(&info) < 0) {
+      free(copy);
+      fclose(file);
+      return FAILURE;
+    }
+    added++;
+  }
+
+  fclose(file);
+  return added;
 }
 
 
@@ -314,48 +271,20 @@ int countHandCoins(int player, struct gameState *game) {
   int card, index, coinage = 0;
 	
   for(index = 0; index < game->handCount[player]; index++) {
-    card = game->hand[player][index];
-    switch(card) {
-    case copper: coinage += COPPER_VALUE;
-      break;
-    case silver: coinage += SILVER_VALUE;
-      break;
-    case gold: coinage += GOLD_VALUE;
-      break;
-    }
+    card = pileCard(game->hand[player][index], game);
+    if(getCardInfo(card) != NULL) coinage += getCardInfo(card)->coins;
   }
   return coinage;
 }
 
 
-void executeBotTurn(int player, int *turnNum, struct gameState *game) {
-  int coins = countHandCoins(player, game);
-	
+void executeBotTurn(int player, int *turnNum, struct botMemory *mem, struct gameState *game) {
   printf("*****************Executing Bot Player %d Turn Number %d*****************\n", player, *turnNum);
   printSupply(game);	
   //sleep(1); //Thinking...
 	
-  if(coins >= PROVINCE_COST && supplyCount(province,game) > 0) {
-    buyCard(province,game);
-    printf("Player %d buys card Province\n\n", player);
-  }
-  else if(supplyCount(province,game) == 0 && coins >= DUCHY_COST ) {
-    buyCard(duchy,game);
-    printf("Player %d buys card Duchy\n\n", player);
-  }
-  else if(coins >= GOLD_COST && supplyCount(gold,game) > 0) {
-    buyCard(gold,game);
-    printf("Player %d buys card Gold\n\n", player);
-  }
-  else if(coins >= SILVER_COST && supplyCount(silver,game) > 0) {
-    buyCard(silver,game);
-    printf("Player %d buys card Silver\n\n", player);
-
-  }
-
-	
   if(player == (game->numPlayers -1)) (*turnNum)++;
-  endTurn(game);
+  playStrategyTurn(findStrategy("bigmoney"), mem, game, stdout);
   if(! isGameOver(game)) {
     int currentPlayer = whoseTurn(game);
     printf("Player %d's turn number %d\n\n", currentPlayer, (*turnNum));
@@ -12,9 +12,8 @@
 
 
 #include "dominion.h"
+#include "strategy.h"
 
-//Last card enum (Treasure map) card number plus one for the 0th card.
-#define NUM_TOTAL_K_CARDS (treasure_map + 1)
 #define NUM_K_CARDS 10
 #define NUM_V_CARDS_2 8
 #define NUM_V_CARDS_3or4 12
@@ -46,51 +45,20 @@
 #define BUY_PHASE 1
 #define CLEANUP_PHASE 2
 
-#define COPPER_VALUE 1
-#define SILVER_VALUE 2
-#define GOLD_VALUE 3
-
-//From Dominion List Spoiler
-#define COPPER_COST 0
-#define SILVER_COST 3
-#define GOLD_COST 6
-#define ESTATE_COST 2
-#define DUCHY_COST 5
-#define PROVINCE_COST 8
-#define CURSE_COST 0
-#define ADVENTURER_COST 6
-#define COUNCIL_ROOM_COST 5
-#define FEAST_COST 4
-#define GARDEN_COST 4
-#define MINE_COST 5
-#define MONEYLENDER_COST 4
-#define REMODEL_COST 4
-#define SMITHY_COST 4
-#define VILLAGE_COST 3
-#define WOODCUTTER_COST 3
-#define BARON_COST 4
-#define GREAT_HALL_COST 3
-#define MINION_COST 5
-#define SHANTY_TOWN_COST 3
-#define STEWARD_COST 3
-#define TRIBUTE_COST 5
-#define WISHING_WELL_COST 3
-#define AMBASSADOR_COST 3
-#define CUTPURSE_COST 4
-#define EMBARGO_COST 2
-#define OUTPOST_COST 5
-#define SALVAGER_COST 4
-#define SEA_HAG_COST 4
-#define TREASURE_MAP_COST 4
+
 #define ONETHOUSAND 1000
 
 
 int addCardToHand(int player, int card, struct gameState *game); 
+//FAILURE for a card with no supply pile in this game
 
 int countHandCoins(int player, struct gameState *game);
 
 
-void executeBotTurn(int player, int *turnNum, struct gameState *game);
+void executeBotTurn(int player, int *turnNum, struct botMemory *mem, struct gameState *game);
+/* Play player's turn with the bigmoney strategy.  mem is what the bot
+   remembers over this game, owned by the caller and zeroed before the
+   game starts */
 
 void phaseNumToName(int phase, char *name); 
 void cardNumToName(int card, char *name);
@@ -117,6 +85,20 @@ void printScores(struct gameState *game);
 
 void selectKingdomCards(int randomSeed, int kingdomCards[NUM_K_CARDS]);
 
+//numKingdom different kingdom cards from the whole pool, added cards
+//included; FAILURE if the pool has fewer
+int selectKingdom(int randomSeed, int *kingdomCards, int numKingdom);
+
+//Add the cards listed in a text file to the pool (see addCard), one per
+//line as
+//  name, cost, types, coins, vp, +cards, +actions, +buys, +coins
+//with types any of treasure, victory, action and attack joined by |,
+//e.g. "Laboratory, 5, action, 0, 0, 2, 1, 0, 0".  Blank lines and lines
+//starting with # are skipped.  Returns how many cards were added, or
+//FAILURE if the file cannot be read or a line is not a card (the cards
+//before it stay added).  Like addCard it fails once a game has been set up
+int loadCardPool(const char *path);
+
 
 
 #endif
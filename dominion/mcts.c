@@ -0,0 +1,484 @@
+/* 	Monte Carlo tree search bot
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <limits.h>
+#include <pthread.h>
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "rngs.h"
+#include "moves.h"
+#include "strategy.h"
+#include "mcts.h"
+
+#define MCTS_DEFAULTS {1000, 0.0, 1.4142135623730951, 0.8, 1.0, 8, 1, 1 << 16, 60, "bigmoney", 1}
+
+//a lead of this many points is most of the way to a sure win
+#define MARGIN_SCALE 10.0
+
+//what a move not yet tried is taken to be worth
+#define FIRST_PLAY 0.5
+
+static const struct mctsConfig defaultConfig = MCTS_DEFAULTS;
+
+struct node {
+  struct move move;   //the move that led here
+  int player;         //who made it
+  int parent;
+  int child;          //first of numChildren, -1 until expanded
+  int numChildren;
+  int visits;
+  double reward;      //summed over visits, for player
+  int preferred;      //1 if the rollout strategy would make this move
+};
+
+struct worker {
+  const struct mctsConfig *config;
+  const struct strategy *rollout;
+  struct gameState *state;
+  int thread;
+  int numThreads;
+  int iterations;     //per world, 0 for no limit
+  double start;
+  int numMoves;       //at the root
+  struct node *nodes;
+  long visits[MAX_MOVES];
+  double reward[MAX_MOVES];
+  struct move moves[MAX_MOVES];
+};
+
+
+static double now(void) {
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+//new random streams for everything drawn from here on
+static void reseed(struct gameState *state, rngStream *r) {
+  rngStream streams[MAX_PLAYERS+1];
+  int p;
+
+  PlantSeedsStream(streams, MAX_PLAYERS+1, state->rng.engine, RandomBelow(r, 2147483646) + 1);
+  state->rng = streams[0];
+  for (p = 0; p < MAX_PLAYERS; p++)
+    state->deckRng[p] = streams[p+1];
+}
+
+//deal out what player cannot see: the other players' hands and decks
+//pooled and dealt again, and every deck in a new order
+static void determinize(struct gameState *state, int player, rngStream *r) {
+  card_t pool[MAX_HAND + MAX_DECK];
+  card_t c;
+  int p, i, j, n, inHand;
+
+  for (p = 0; p < state->numPlayers; p++)
+    {
+      inHand = (p == player) ? 0 : state->handCount[p];
+      memcpy(pool, state->hand[p], inHand * sizeof(card_t));
+      memcpy(pool + inHand, state->deck[p], state->deckCount[p] * sizeof(card_t));
+      n = inHand + state->deckCount[p];
+
+      for (i = n - 1; i > 0; i--)
+	{
+	  j = RandomBelow(r, i + 1);
+	  c = pool[i];
+	  pool[i] = pool[j];
+	  pool[j] = c;
+	}
+
+      memcpy(state->hand[p], pool, inHand * sizeof(card_t));
+      memcpy(state->deck[p], pool + inHand, state->deckCount[p] * sizeof(card_t));
+      recountCards(p, state);
+    }
+  reseed(state, r);
+}
+
+//the best UCT value plus the pull toward the rollout strategy's move.
+//A child not yet visited counts as an even game seen once
+static int selectChild(struct node *nodes, int parent, double exploration, double bias) {
+  struct node *n = &nodes[parent];
+  double logVisits = log(n->visits);
+  double value, mean;
+  double best = -1;
+  int pick = n->child;
+  int i, visits;
+
+  for (i = n->child; i < n->child + n->numChildren; i++)
+    {
+      visits = nodes[i].visits > 0 ? nodes[i].visits : 1;
+      mean = nodes[i].visits > 0 ? nodes[i].reward / nodes[i].visits : FIRST_PLAY;
+      value = mean + exploration * sqrt(logVisits / visits) +
+	bias * nodes[i].preferred / (nodes[i].visits + 1);
+      if (value > best)
+	{
+	  best = value;
+	  pick = i;
+	}
+    }
+  return pick;
+}
+
+//play on until the game ends or the turn limit
+static void playOut(struct gameState *state, struct worker *w, rngStream *r) {
+  struct botMemory mem[MAX_PLAYERS];
+  struct move m;
+  int turns = 0;
+  int n;
+
+  memset(mem, 0, sizeof(mem));
+  while (!isGameOver(state) && turns < w->config->rolloutTurns)
+    {
+      if (w->rollout != NULL)
+	playStrategyTurn(w->rollout, &mem[whoseTurn(state)], state, NULL);
+      else
+	{
+	  do
+	    {
+	      n = legalMoves(state, w->moves, MAX_MOVES);
+	      m = w->moves[RandomBelow(r, n < MAX_MOVES ? n : MAX_MOVES)];
+	      if (makeMove(&m, state) < 0)
+		{
+		  endTurn(state);
+		  break;
+		}
+	    }
+	  while (m.type != MOVE_END);
+	}
+      turns++;
+    }
+}
+
+//1 for a win, shared between tied winners, mixed with how far each
+//player finished ahead of the best of the others
+static void score(struct gameState *state, double margin, double reward[MAX_PLAYERS]) {
+  int winners[MAX_PLAYERS];
+  int points[MAX_PLAYERS];
+  int p, q, lead;
+  int n = 0;
+
+  getWinners(winners, state);
+  for (p = 0; p < MAX_PLAYERS; p++)
+    {
+      n += winners[p];
+      points[p] = p < state->numPlayers ? scoreFor(p, state) : 0;
+    }
+  for (p = 0; p < MAX_PLAYERS; p++)
+    {
+      lead = INT_MAX;
+      for (q = 0; q < state->numPlayers; q++)
+	{
+	  if (q != p && points[p] - points[q] < lead)
+	    lead = points[p] - points[q];
+	}
+      if (lead == INT_MAX)
+	lead = 0;
+      reward[p] = (1 - margin) * (n > 0 ? (double) winners[p] / n : 0) +
+	margin * (0.5 + 0.5 * tanh(lead / MARGIN_SCALE));
+    }
+}
+
+//which of moves the rollout strategy would make itself, -1 for none
+static int policyMove(struct worker *w, struct gameState *state, struct move *moves, int n) {
+  struct botMemory mem;
+  int choice1, choice2, choice3;
+  int pos, card, i;
+
+  if (w->rollout == NULL)
+    return -1;
+  memset(&mem, 0, sizeof(mem));
+  mem.player = whoseTurn(state);
+  mem.config = w->rollout->config;
+
+  //a play is matched by its card, the strategy's choices may differ
+  if (state->phase == 0 && state->numActions > 0 && w->rollout->action != NULL)
+    {
+      choice1 = choice2 = choice3 = -1;
+      pos = w->rollout->action(state, &mem, &choice1, &choice2, &choice3);
+      if (pos >= 0 && pos < numHandCards(state))
+	{
+	  card = handCard(pos, state);
+	  for (i = 0; i < n; i++)
+	    {
+	      if (moves[i].type == MOVE_PLAY && moves[i].card == card)
+		return i;
+	    }
+	}
+    }
+
+  card = w->rollout->buy != NULL ? w->rollout->buy(state, &mem, state->coins) : -1;
+  for (i = 0; i < n; i++)
+    {
+      if (card >= 0 ? moves[i].type == MOVE_BUY && moves[i].card == card :
+	  moves[i].type == MOVE_END)
+	return i;
+    }
+  return -1;
+}
+
+//one playout from world: down the tree, grow it by one node, play out
+//and back the result up.  used is how much of the node pool is taken
+static void iterate(struct worker *w, struct gameState *world, rngStream *r, int *used) {
+  struct gameState state;
+  struct node *nodes = w->nodes;
+  double reward[MAX_PLAYERS];
+  int node = 0;
+  int n, i, preferred;
+
+  copyGameState(&state, world);
+
+  while (nodes[node].child >= 0 && !isGameOver(&state))
+    {
+      node = selectChild(nodes, node, w->config->exploration, w->config->bias);
+      if (makeMove(&nodes[node].move, &state) < 0)
+	break;
+    }
+
+  if (nodes[node].child < 0 && !isGameOver(&state))
+    {
+      n = legalMoves(&state, w->moves, MAX_MOVES);
+      if (n > MAX_MOVES)
+	n = MAX_MOVES;
+      if (*used + n <= w->config->maxNodes)
+	{
+	  preferred = policyMove(w, &state, w->moves, n);
+	  for (i = 0; i < n; i++)
+	    {
+	      nodes[*used + i].move = w->moves[i];
+	      nodes[*used + i].player = whoseTurn(&state);
+	      nodes[*used + i].parent = node;
+	      nodes[*used + i].child = -1;
+	      nodes[*used + i].numChildren = 0;
+	      nodes[*used + i].visits = 0;
+	      nodes[*used + i].reward = 0;
+	      nodes[*used + i].preferred = i == preferred;
+	    }
+	  nodes[node].child = *used;
+	  nodes[node].numChildren = n;
+	  *used += n;
+
+	  //the rollout strategy's move is tried first
+	  node = nodes[node].child + (preferred > 0 ? preferred : 0);
+	  makeMove(&nodes[node].move, &state);
+	}
+    }
+
+  //the tree's own moves replay the same way every time, what comes
+  //after is drawn afresh
+  reseed(&state, r);
+  playOut(&state, w, r);
+  score(&state, w->config->margin, reward);
+
+  for (; node >= 0; node = nodes[node].parent)
+    {
+      nodes[node].visits++;
+      nodes[node].reward += reward[nodes[node].player];
+    }
+}
+
+//worlds thread, thread + numThreads, ... each searched with its own tree
+static void *runWorker(void *arg) {
+  struct worker *w = arg;
+  const struct mctsConfig *config = w->config;
+  struct gameState world;
+  rngStream r;
+  int numWorlds = (config->worlds - w->thread + w->numThreads - 1) / w->numThreads;
+  int k, j, i, used;
+  double deadline = 0;
+
+  for (k = w->thread, j = 0; k < config->worlds; k += w->numThreads, j++)
+    {
+      //each world's stream depends only on the seed and its number
+      SeedStream(&r, RNG_SPLITMIX, config->seed);
+      r.x += (unsigned long long) k * (0x9E3779B97F4A7C15ULL << 40);
+
+      copyGameState(&world, w->state);
+      determinize(&world, whoseTurn(w->state), &r);
+
+      w->nodes[0].player = 0;
+      w->nodes[0].parent = -1;
+      w->nodes[0].child = -1;
+      w->nodes[0].numChildren = 0;
+      w->nodes[0].visits = 0;
+      w->nodes[0].reward = 0;
+      w->nodes[0].preferred = 0;
+      used = 1;
+
+      if (config->seconds > 0)
+	deadline = w->start + config->seconds * (j + 1) / numWorlds;
+      for (i = 0; w->iterations == 0 || i < w->iterations; i++)
+	{
+	  if (i > 0 && config->seconds > 0 && now() >= deadline)
+	    break;
+	  iterate(w, &world, &r, &used);
+	}
+
+      //the root moves only depend on what the player can see, so they
+      //line up across worlds
+      if (w->nodes[0].numChildren != w->numMoves)
+	continue;
+      for (i = 0; i < w->numMoves; i++)
+	{
+	  w->visits[i] += w->nodes[w->nodes[0].child + i].visits;
+	  w->reward[i] += w->nodes[w->nodes[0].child + i].reward;
+	}
+    }
+
+  return NULL;
+}
+
+int mctsChoose(struct gameState *state, const struct mctsConfig *config, struct move *best) {
+  struct worker *workers;
+  struct move *moves;
+  pthread_t threads[MCTS_MAX_THREADS];
+  int started[MCTS_MAX_THREADS];
+  const struct strategy *rollout = NULL;
+  long visits;
+  double reward, bestReward = 0;
+  long bestVisits = -1;
+  int numThreads, n, t, i;
+  int result = 0;
+
+  if ((config->iterations <= 0 && config->seconds <= 0) || config->worlds < 1)
+    return -1;
+  if (config->rollout != NULL && (rollout = findStrategy(config->rollout)) == NULL)
+    return -1;
+
+  moves = malloc(MAX_MOVES * sizeof(struct move));
+  if (moves == NULL)
+    return -1;
+  n = legalMoves(state, moves, MAX_MOVES);
+  if (n > MAX_MOVES)
+    n = MAX_MOVES;
+
+  //nothing to weigh up
+  if (n == 1)
+    {
+      *best = moves[0];
+      free(moves);
+      return 0;
+    }
+  if (config->maxNodes <= n)
+    {
+      free(moves);
+      return -1;
+    }
+
+  numThreads = config->threads;
+  if (numThreads > config->worlds)
+    numThreads = config->worlds;
+  if (numThreads > MCTS_MAX_THREADS)
+    numThreads = MCTS_MAX_THREADS;
+  if (numThreads < 1)
+    numThreads = 1;
+
+  workers = calloc(numThreads, sizeof(struct worker));
+  if (workers == NULL)
+    {
+      free(moves);
+      return -1;
+    }
+  for (t = 0; t < numThreads; t++)
+    {
+      workers[t].config = config;
+      workers[t].rollout = rollout;
+      workers[t].state = state;
+      workers[t].thread = t;
+      workers[t].numThreads = numThreads;
+      workers[t].iterations = config->iterations > 0 ? config->iterations / config->worlds : 0;
+      if (config->iterations > 0 && workers[t].iterations < 1)
+	workers[t].iterations = 1;
+      workers[t].start = now();
+      workers[t].numMoves = n;
+      workers[t].nodes = malloc(config->maxNodes * sizeof(struct node));
+      if (workers[t].nodes == NULL)
+	result = -1;
+    }
+
+  if (result == 0)
+    {
+      //the calling thread searches its own share, and any thread that
+      //will not start is run here too
+      for (t = 1; t < numThreads; t++)
+	started[t] = pthread_create(&threads[t], NULL, runWorker, &workers[t]) == 0;
+      runWorker(&workers[0]);
+      for (t = 1; t < numThreads; t++)
+	{
+	  if (started[t])
+	    pthread_join(threads[t], NULL);
+	  else
+	    runWorker(&workers[t]);
+	}
+
+      //most visited, then best average
+      for (i = 0; i < n; i++)
+	{
+	  visits = 0;
+	  reward = 0;
+	  for (t = 0; t < numThreads; t++)
+	    {
+	      visits += workers[t].visits[i];
+	      reward += workers[t].reward[i];
+	    }
+	  if (visits > 0)
+	    reward /= visits;
+	  if (visits > bestVisits || (visits == bestVisits && reward > bestReward))
+	    {
+	      bestVisits = visits;
+	      bestReward = reward;
+	      *best = moves[i];
+	    }
+	}
+    }
+
+  for (t = 0; t < numThreads; t++)
+    free(workers[t].nodes);
+  free(workers);
+  free(moves);
+  return result;
+}
+
+void mctsDefaults(struct mctsConfig *config) {
+  struct mctsConfig defaults = MCTS_DEFAULTS;
+
+  *config = defaults;
+}
+
+
+//what the strategy was registered with, the defaults if nothing
+static const struct mctsConfig *mctsConfigOf(struct botMemory *mem) {
+  return mem->config != NULL ? mem->config : &defaultConfig;
+}
+
+//the search picks the play; anything else ends the action phase
+static int mctsAction(struct gameState *state, struct botMemory *mem,
+		      int *choice1, int *choice2, int *choice3) {
+  struct move m;
+
+  if (mctsChoose(state, mctsConfigOf(mem), &m) < 0 || m.type != MOVE_PLAY)
+    return -1;
+  *choice1 = m.choice1;
+  *choice2 = m.choice2;
+  *choice3 = m.choice3;
+  return m.handPos;
+}
+
+//searched as if the action phase were over, so plays are not offered
+static int mctsBuy(struct gameState *state, struct botMemory *mem, int money) {
+  struct gameState view;
+  struct move m;
+
+  copyGameState(&view, state);
+  view.phase = 1;
+  if (mctsChoose(&view, mctsConfigOf(mem), &m) < 0 || m.type != MOVE_BUY)
+    return -1;
+  return m.card;
+}
+
+const struct strategy mctsStrategy = {"mcts", mctsAction, NULL, mctsBuy, &defaultConfig};
@@ -0,0 +1,347 @@
+/* 	Legal move generator
+*/
+
+#include <string.h>
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "moves.h"
+
+
+//append a move if there is room, the count goes up either way
+static void addMove(struct move *moves, int max, int *n, int type, int card,
+		    int handPos, int choice1, int choice2, int choice3) {
+  if (*n < max)
+    {
+      moves[*n].type = type;
+      moves[*n].card = card;
+      moves[*n].handPos = handPos;
+      moves[*n].choice1 = choice1;
+      moves[*n].choice2 = choice2;
+      moves[*n].choice3 = choice3;
+    }
+  (*n)++;
+}
+
+//do to a copy of a hand what discardCard does to the real one: take out
+//the card at each of pos[0..n-1] in turn and note its pile in removed.
+//-1 if a position is past the end of what is left
+static int takeOut(card_t *hand, int *count, const int *pos, int n, int *removed) {
+  int i;
+
+  for (i = 0; i < n; i++)
+    {
+      if (pos[i] < 0 || pos[i] >= *count)
+	return -1;
+      removed[i] = hand[pos[i]];
+      if (pos[i] != *count - 1)
+	hand[pos[i]] = hand[*count - 1];
+      (*count)--;
+    }
+  return 0;
+}
+
+//same as takeOut, starting from the current player's hand, with the
+//cards rather than their piles in removed
+static int takeOutOfHand(struct gameState *state, const int *pos, int n, int *removed) {
+  card_t hand[MAX_HAND];
+  int count = numHandCards(state);
+  int i;
+
+  memcpy(hand, state->hand[whoseTurn(state)], count * sizeof(card_t));
+  if (takeOut(hand, &count, pos, n, removed) < 0)
+    return -1;
+  for (i = 0; i < n; i++)
+    removed[i] = pileCard(removed[i], state);
+  return 0;
+}
+
+//position of the first copy of card in hand other than skip, -1 if none
+static int findInHand(struct gameState *state, int card, int skip) {
+  int i;
+
+  for (i = 0; i < numHandCards(state); i++)
+    {
+      if (i != skip && handCard(i, state) == card)
+	return i;
+    }
+  return -1;
+}
+
+//treasure cards in player's deck and discard
+static int treasureLeft(int player, struct gameState *state) {
+  int n = fullDeckCount(player, copper, state) + fullDeckCount(player, silver, state) +
+    fullDeckCount(player, gold, state);
+  int i;
+
+  for (i = 0; i < state->handCount[player]; i++)
+    {
+      if (pileCard(state->hand[player][i], state) >= copper &&
+	  pileCard(state->hand[player][i], state) <= gold)
+	n--;
+    }
+  return n;
+}
+
+//every card in hand, other than the one at handPos, traded for a card
+//still in the supply.  cardEffect wants the new card to cost at least
+//plus more than the old one (the printed cards say at most), and that is
+//what it accepts
+static void addTrades(struct gameState *state, struct move *moves, int max, int *n,
+		      int card, int handPos, int plus, int treasureOnly) {
+  int seen[MAX_SUPPLY];
+  int i, c, p, gain;
+
+  memset(seen, 0, sizeof(seen));
+  for (i = 0; i < numHandCards(state); i++)
+    {
+      c = handCard(i, state);
+      if (i == handPos || supplyPile(c, state) < 0 || seen[supplyPile(c, state)])
+	continue;
+      seen[supplyPile(c, state)] = 1;
+      if (treasureOnly && (c < copper || c > gold))
+	continue;
+      for (p = 0; p < state->numPiles; p++)
+	{
+	  gain = state->supplyCard[p];
+	  if (state->pileCount[p] > 0 && getCost(gain) >= getCost(c) + plus)
+	    addMove(moves, max, n, MOVE_PLAY, card, handPos, i, gain, -1);
+	}
+    }
+}
+
+static void addSteward(struct gameState *state, struct move *moves, int max, int *n,
+		       int handPos, int seenPair[MAX_SUPPLY][MAX_SUPPLY]) {
+  int pos[3];
+  int removed[3];
+  int a, b;
+  int count = numHandCards(state);
+
+  //trash the cards at pos[0] and pos[1], then steward leaves from handPos
+  pos[2] = handPos;
+  for (pos[0] = 0; pos[0] < count; pos[0]++)
+    {
+      for (pos[1] = 0; pos[1] < count - 1; pos[1]++)
+	{
+	  if (takeOutOfHand(state, pos, 3, removed) < 0 || removed[2] != steward)
+	    continue;
+	  //piles are in card order, so the lower pile is the lower card
+	  a = supplyPile(removed[0] < removed[1] ? removed[0] : removed[1], state);
+	  b = supplyPile(removed[0] < removed[1] ? removed[1] : removed[0], state);
+	  if (a < 0 || b < 0 || seenPair[a][b])
+	    continue;
+	  seenPair[a][b] = 1;
+	  addMove(moves, max, n, MOVE_PLAY, steward, handPos, 0, pos[0], pos[1]);
+	}
+    }
+}
+
+static void addAmbassador(struct gameState *state, struct move *moves, int max, int *n,
+			  int handPos) {
+  int seen[MAX_SUPPLY];
+  int count = numHandCards(state);
+  int removed[1];
+  card_t hand[MAX_HAND];
+  int left;
+  int i, k, c, copies, give;
+
+  memset(seen, 0, sizeof(seen));
+  for (i = 0; i < count; i++)
+    {
+      c = handCard(i, state);
+      if (i == handPos || supplyPile(c, state) < 0 || seen[supplyPile(c, state)])
+	continue;
+      seen[supplyPile(c, state)] = 1;
+
+      copies = 0;
+      for (k = 0; k < count; k++)
+	{
+	  if (k != handPos && k != i && handCard(k, state) == c)
+	    copies++;
+	}
+      //cardEffect's own check compares positions with the card, so it
+      //lets at most one copy go back, and only for some cards
+      if (!(c < count && c != handPos && c != i))
+	copies = 0;
+      else if (copies > 1)
+	copies = 1;
+
+      //returned copies are found by looking at position i again once the
+      //Ambassador has left, so that must still be the revealed card
+      memcpy(hand, state->hand[whoseTurn(state)], count * sizeof(card_t));
+      left = count;
+      takeOut(hand, &left, &handPos, 1, removed);
+      if (i >= left || pileCard(hand[i], state) != c)
+	copies = 0;
+
+      for (give = 0; give <= copies && give <= 2; give++)
+	addMove(moves, max, n, MOVE_PLAY, ambassador, handPos, i, give, -1);
+    }
+}
+
+//plays of card from handPos; handPos is the first copy in hand unless the
+//card's choices depend on where it is.  seenPair holds the pairs of piles
+//Steward has trashed so far, seenTrash the piles Salvager has
+static void addPlays(struct gameState *state, struct move *moves, int max, int *n,
+		     int card, int handPos, int seenPair[MAX_SUPPLY][MAX_SUPPLY],
+		     int seenTrash[MAX_SUPPLY]) {
+  int player = whoseTurn(state);
+  int next = (player + 1) % state->numPlayers;
+  int pos[2];
+  int removed[2];
+  int i, p, c;
+
+  switch (card)
+    {
+    case adventurer:
+      if (treasureLeft(player, state) >= 2)
+	addMove(moves, max, n, MOVE_PLAY, card, handPos, -1, -1, -1);
+      break;
+
+    case feast:
+      for (p = 0; p < state->numPiles; p++)
+	{
+	  c = state->supplyCard[p];
+	  if (state->pileCount[p] > 0 && getCost(c) <= 5)
+	    addMove(moves, max, n, MOVE_PLAY, card, handPos, c, -1, -1);
+	}
+      break;
+
+    case gardens:
+      break;
+
+    case mine:
+      addTrades(state, moves, max, n, card, handPos, 3, 1);
+      break;
+
+    case remodel:
+      addTrades(state, moves, max, n, card, handPos, 2, 0);
+      break;
+
+    case baron:
+      addMove(moves, max, n, MOVE_PLAY, card, handPos, 0, -1, -1);
+      if (findInHand(state, estate, handPos) >= 0)
+	addMove(moves, max, n, MOVE_PLAY, card, handPos, 1, -1, -1);
+      break;
+
+    case minion:
+      addMove(moves, max, n, MOVE_PLAY, card, handPos, 1, 0, -1);
+      addMove(moves, max, n, MOVE_PLAY, card, handPos, 0, 1, -1);
+      break;
+
+    case steward:
+      if (findInHand(state, steward, -1) == handPos)
+	{
+	  addMove(moves, max, n, MOVE_PLAY, card, handPos, 1, -1, -1);
+	  addMove(moves, max, n, MOVE_PLAY, card, handPos, 2, -1, -1);
+	}
+      addSteward(state, moves, max, n, handPos, seenPair);
+      break;
+
+    case tribute:
+      //cardEffect lowers the deck count four times for its two cards
+      if (state->deckCount[next] + state->discardCount[next] <= 1 ||
+	  state->deckCount[next] >= 4)
+	addMove(moves, max, n, MOVE_PLAY, card, handPos, -1, -1, -1);
+      break;
+
+    case ambassador:
+      addAmbassador(state, moves, max, n, handPos);
+      break;
+
+    case embargo:
+      for (p = 0; p < state->numPiles; p++)
+	addMove(moves, max, n, MOVE_PLAY, card, handPos, state->supplyCard[p], -1, -1);
+      break;
+
+    case salvager:
+      //choice1 0 means trash nothing, so the first card can never go
+      if (findInHand(state, salvager, -1) == handPos)
+	addMove(moves, max, n, MOVE_PLAY, card, handPos, 0, -1, -1);
+      pos[1] = handPos;
+      for (pos[0] = 1; pos[0] < numHandCards(state); pos[0]++)
+	{
+	  if (takeOutOfHand(state, pos, 2, removed) < 0 || removed[1] != salvager ||
+	      supplyPile(removed[0], state) < 0 || seenTrash[supplyPile(removed[0], state)])
+	    continue;
+	  seenTrash[supplyPile(removed[0], state)] = 1;
+	  addMove(moves, max, n, MOVE_PLAY, card, handPos, pos[0], -1, -1);
+	}
+      break;
+
+    case sea_hag:
+      for (i = 0; i < state->numPlayers; i++)
+	{
+	  if (i != player && state->deckCount[i] < 3)
+	    return;
+	}
+      addMove(moves, max, n, MOVE_PLAY, card, handPos, -1, -1, -1);
+      break;
+
+    case treasure_map:
+      //both maps must be the ones that get trashed
+      pos[0] = handPos;
+      pos[1] = findInHand(state, treasure_map, handPos);
+      if (pos[1] >= 0 && takeOutOfHand(state, pos, 2, removed) == 0 &&
+	  removed[0] == treasure_map && removed[1] == treasure_map)
+	addMove(moves, max, n, MOVE_PLAY, card, handPos, -1, -1, -1);
+      break;
+
+    default:
+      addMove(moves, max, n, MOVE_PLAY, card, handPos, -1, -1, -1);
+    }
+}
+
+int legalMoves(struct gameState *state, struct move *moves, int max) {
+  int seenPair[MAX_SUPPLY][MAX_SUPPLY];
+  int seenTrash[MAX_SUPPLY];
+  int played[MAX_SUPPLY];
+  int n = 0;
+  int before;
+  int i, p, card;
+
+  //action phase
+  if (state->phase == 0 && state->numActions > 0)
+    {
+      memset(seenPair, 0, sizeof(seenPair));
+      memset(seenTrash, 0, sizeof(seenTrash));
+      memset(played, 0, sizeof(played));
+      for (i = 0; i < numHandCards(state); i++)
+	{
+	  card = handCard(i, state);
+	  p = supplyPile(card, state);
+	  if (p < 0 || !(getCardInfo(card)->types & CARD_ACTION))
+	    continue;
+	  if (played[p])
+	    continue;
+	  before = n;
+	  addPlays(state, moves, max, &n, card, i, seenPair, seenTrash);
+	  //copies play alike, except Steward, Salvager and Treasure Map,
+	  //whose choices depend on where they are: try every copy of those
+	  if (card != steward && card != salvager && (card != treasure_map || n > before))
+	    played[p] = 1;
+	}
+    }
+
+  //buy phase
+  if (state->numBuys > 0)
+    {
+      for (p = 0; p < state->numPiles; p++)
+	{
+	  card = state->supplyCard[p];
+	  if (state->pileCount[p] > 0 && state->coins >= getCost(card))
+	    addMove(moves, max, &n, MOVE_BUY, card, -1, -1, -1, -1);
+	}
+    }
+
+  addMove(moves, max, &n, MOVE_END, -1, -1, -1, -1, -1);
+
+  return n;
+}
+
+int makeMove(struct move *m, struct gameState *state) {
+  if (m->type == MOVE_PLAY)
+    return playCard(m->handPos, m->choice1, m->choice2, m->choice3, state);
+  if (m->type == MOVE_BUY)
+    return buyCard(m->card, state);
+  return endTurn(state);
+}
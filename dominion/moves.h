@@ -0,0 +1,41 @@
+/* 	Legal move generator
+
+	Lists what the current player can do right now: every action card
+	play with choices the engine accepts, every card they can buy, and
+	ending the turn.  The state is only read.
+*/
+
+#ifndef _MOVES_H
+#define _MOVES_H
+
+#include "dominion.h"
+
+#define MOVE_PLAY 0
+#define MOVE_BUY 1
+#define MOVE_END 2
+
+/* More than any hand can produce (a full hand of Remodel targets plus
+   every Steward pair is under 1200) */
+#define MAX_MOVES 2048
+
+struct move {
+  int type;       /* MOVE_PLAY, MOVE_BUY or MOVE_END */
+  int card;       /* card played or bought, -1 for MOVE_END */
+  int handPos;    /* MOVE_PLAY: where the card is in hand */
+  int choice1;
+  int choice2;
+  int choice3;
+};
+
+int legalMoves(struct gameState *state, struct move *moves, int max);
+/* Store up to max moves and return how many there are in all.  Plays
+   that end the same way (the same card from another hand position, or
+   the same cards trashed in another order) are listed once, and plays
+   that would hit a known engine fault (Adventurer with fewer than two
+   treasures to find, Feast with nothing it can gain, Tribute and Sea
+   Hag on a short deck) are left out */
+
+int makeMove(struct move *m, struct gameState *state);
+/* playCard, buyCard or endTurn as m says, with their return value */
+
+#endif
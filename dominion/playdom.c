@@ -1,7 +1,9 @@
 #include "dominion.h"
+#include "strategy.h"
 #include <stdio.h>
 #include "rngs.h"
 #include <stdlib.h>
+#include <string.h>
 
 int main (int argc, char** argv) {
   struct gameState G;
@@ -10,122 +12,29 @@ int main (int argc, char** argv) {
 
   printf ("Starting game.\n");
 
-  initializeGame(2, k, atoi(argv[1]), &G);
-
-  int money = 0;
-  int smithyPos = -1;
-  int adventurerPos = -1;
-  int i=0;
-
-  int numSmithies = 0;
-  int numAdventurers = 0;
+  //./playdom <seed> legacy replays games recorded before the fast shuffle,
+  //./playdom <seed> fast uses the SplitMix generator,
+  //./playdom <seed> crn gives each player its own shuffle stream
+  int options = 0;
+  int arg;
+  for (arg = 2; arg < argc; arg++) {
+    if (strcmp(argv[arg], "legacy") == 0)
+      options |= GAME_LEGACY_SHUFFLE;
+    else if (strcmp(argv[arg], "fast") == 0)
+      options |= GAME_FAST_RNG;
+    else if (strcmp(argv[arg], "crn") == 0)
+      options |= GAME_CRN;
+  }
+  initializeGameOpts(2, k, atoi(argv[1]), options, &G);
+
+  //player 0 plays Smithy, player 1 plays Adventurer
+  const struct strategy *bots[2] = {findStrategy("smithy"), findStrategy("adventurer")};
+  struct botMemory mem[2];
+  memset(mem, 0, sizeof(mem));
 
   while (!isGameOver(&G)) {
-    money = 0;
-    smithyPos = -1;
-    adventurerPos = -1;
-    for (i = 0; i < numHandCards(&G); i++) {
-      if (handCard(i, &G) == copper)
-    money++;
-      else if (handCard(i, &G) == silver)
-    money += 2;
-      else if (handCard(i, &G) == gold)
-    money += 3;
-      else if (handCard(i, &G) == smithy)
-    smithyPos = i;
-      else if (handCard(i, &G) == adventurer)
-    adventurerPos = i;
-    }
-
-    if (whoseTurn(&G) == 0) {
-      if (smithyPos != -1) {
-        printf("0: smithy played from position %d\n", smithyPos);
-        playCard(smithyPos, -1, -1, -1, &G);
-        printf("smithy played.\n");
-        money = 0;
-        i=0;
-        while(i<numHandCards(&G)){
-          if (handCard(i, &G) == copper){
-            playCard(i, -1, -1, -1, &G);
-            money++;
-          }
-          else if (handCard(i, &G) == silver){
-            playCard(i, -1, -1, -1, &G);
-            money += 2;
-          }
-          else if (handCard(i, &G) == gold){
-            playCard(i, -1, -1, -1, &G);
-            money += 3;
-          }
-          i++;
-        }
-      }
-
-      if (money >= 8) {
-        printf("0: bought province\n");
-        buyCard(province, &G);
-      }
-      else if (money >= 6) {
-        printf("0: bought gold\n");
-        buyCard(gold, &G);
-      }
-      else if ((money >= 4) && (numSmithies < 2)) {
-        printf("0: bought smithy\n");
-        buyCard(smithy, &G);
-        numSmithies++;
-      }
-      else if (money >= 3) {
-        printf("0: bought silver\n");
-        buyCard(silver, &G);
-      }
-
-      printf("0: end turn\n");
-      endTurn(&G);
-    }
-    else {
-      if (adventurerPos != -1) {
-        printf("1: adventurer played from position %d\n", adventurerPos);
-        playCard(adventurerPos, -1, -1, -1, &G);
-        money = 0;
-        i=0;
-        while(i<numHandCards(&G)){
-          if (handCard(i, &G) == copper){
-            playCard(i, -1, -1, -1, &G);
-            money++;
-          }
-          else if (handCard(i, &G) == silver){
-            playCard(i, -1, -1, -1, &G);
-            money += 2;
-          }
-          else if (handCard(i, &G) == gold){
-            playCard(i, -1, -1, -1, &G);
-            money += 3;
-          }
-          i++;
-        }
-      }
-
-      if (money >= 8) {
-        printf("1: bought province\n");
-        buyCard(province, &G);
-      }
-      else if ((money >= 6) && (numAdventurers < 2)) {
-        printf("1: bought adventurer\n");
-        buyCard(adventurer, &G);
-        numAdventurers++;
-      }else if (money >= 6){
-        printf("1: bought gold\n");
-	    buyCard(gold, &G);
-        }
-      else if (money >= 3){
-        printf("1: bought silver\n");
-	    buyCard(silver, &G);
-      }
-      printf("1: endTurn\n");
-
-      endTurn(&G);
-    }
-  } // end of While
+    playStrategyTurn(bots[whoseTurn(&G)], &mem[whoseTurn(&G)], &G, stdout);
+  }
 
   printf ("Finished game.\n");
   printf ("Player 0: %d\nPlayer 1: %d\n", scoreFor(0, &G), scoreFor(1, &G));
@@ -51,6 +51,7 @@ int main(int argc, char* argv[]) {
 
 	//Array to hold bot presence 
 	int isBot[MAX_PLAYERS] = { 0, 0, 0, 0};
+	struct botMemory botMem[MAX_PLAYERS];
 
 	int players[MAX_PLAYERS];
 	int playerNum;
@@ -69,6 +70,7 @@ int main(int argc, char* argv[]) {
 	struct gameState * game = &g;
 
 	memset(game,0,sizeof(struct gameState));
+	memset(botMem,0,sizeof(botMem));
 		
 	if(argc != 2){
 		printf("Usage: player [integer random number seed]\n");
@@ -119,7 +121,7 @@ int main(int argc, char* argv[]) {
 		
 
 		if(isBot[currentPlayer] == TRUE) {
-				executeBotTurn(currentPlayer, &turnNum, game);
+				executeBotTurn(currentPlayer, &turnNum, &botMem[currentPlayer], game);
 				continue;
 		}
 		
@@ -164,6 +166,7 @@ int main(int argc, char* argv[]) {
 			}			
 	//		selectKingdomCards(randomSeed, kCards);  //Comment this out to use the default card set defined in playDom.
 			outcome = initializeGame(arg0, kCards, randomSeed, game);
+			memset(botMem,0,sizeof(botMem));
 			printf("\n");
 			if(outcome == SUCCESS){
 				gameStarted = TRUE;
@@ -48,10 +48,9 @@ static int  stream        = 0;          /* stream index, 0 is the default */
 static int  initialized   = 0;          /* test for stream initialization */
 
 
-   double Random(void)
+   static double Step(long *x)
 /* ----------------------------------------------------------------
- * Random returns a pseudo-random real number uniformly distributed 
- * between 0.0 and 1.0. 
+ * Advance the Lehmer state *x by one and return it scaled to (0,1).
  * ----------------------------------------------------------------
  */
 {
@@ -59,12 +58,90 @@ static int  initialized   = 0;          /* test for stream initialization */
   const long R = MODULUS % MULTIPLIER;
         long t;
 
-  t = MULTIPLIER * (seed[stream] % Q) - R * (seed[stream] / Q);
+  t = MULTIPLIER * (*x % Q) - R * (*x / Q);
   if (t > 0) 
-    seed[stream] = t;
+    *x = t;
   else 
-    seed[stream] = t + MODULUS;
-  return ((double) seed[stream] / MODULUS);
+    *x = t + MODULUS;
+  return ((double) *x / MODULUS);
+}
+
+
+   double Random(void)
+/* ----------------------------------------------------------------
+ * Random returns a pseudo-random real number uniformly distributed 
+ * between 0.0 and 1.0. 
+ * ----------------------------------------------------------------
+ */
+{
+  return (Step(&seed[stream]));
+}
+
+
+   static unsigned long long SplitMix(unsigned long long *x)
+/* ----------------------------------------------------------------
+ * Advance the SplitMix64 state *x and return the next 64 bits.
+ * See Steele, Lea & Flood, "Fast Splittable Pseudorandom Number
+ * Generators", OOPSLA 2014.
+ * ----------------------------------------------------------------
+ */
+{
+  unsigned long long z;
+
+  z = (*x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return (z ^ (z >> 31));
+}
+
+
+   double RandomStream(rngStream *r)
+/* ----------------------------------------------------------------
+ * Same as Random, but draws from the caller's stream r instead of
+ * the library's current stream, so independent streams can be used
+ * from different threads.  An RNG_SPLITMIX stream returns the centre
+ * of one of 2^53 equal steps, so like Random it never returns 0.0 or
+ * 1.0.  A Lehmer stream whose state is out of range (never
+ * seeded, or overwritten) restarts from DEFAULT.
+ * ----------------------------------------------------------------
+ */
+{
+  if (r->engine == RNG_SPLITMIX)
+    return (((SplitMix(&r->x) >> 11) + 0.5) * (1.0 / 9007199254740992.0));
+  if (r->seed <= 0 || r->seed >= MODULUS)
+    r->seed = DEFAULT;
+  return (Step(&r->seed));
+}
+
+
+   int RandomBelow(rngStream *r, int n)
+/* ----------------------------------------------------------------
+ * Returns a uniformly distributed integer in 0 .. n-1 (n > 0).  On a
+ * Lehmer stream this is exactly floor(RandomStream(r) * n), so it
+ * can replace that expression without changing any results.  On a
+ * SplitMix stream it uses Lemire's multiply-and-shift with
+ * rejection ("Fast Random Integer Generation in an Interval", 2019),
+ * which needs no floating point and almost never divides.
+ * ----------------------------------------------------------------
+ */
+{
+  unsigned long long m;
+  unsigned long      l;
+  unsigned long      t;
+
+  if (r->engine != RNG_SPLITMIX)
+    return ((int) (RandomStream(r) * n));
+
+  m = (SplitMix(&r->x) >> 32) * (unsigned long long) n;
+  l = (unsigned long) (m & 0xFFFFFFFFUL);
+  if (l < (unsigned long) n) {
+    t = (0x100000000ULL - n) % n;        /* 2^32 mod n */
+    while (l < t) {
+      m = (SplitMix(&r->x) >> 32) * (unsigned long long) n;
+      l = (unsigned long) (m & 0xFFFFFFFFUL);
+    }
+  }
+  return ((int) (m >> 32));
 }
 
 
@@ -107,6 +184,20 @@ static int  initialized   = 0;          /* test for stream initialization */
  *    if x = 0 then the state is to be supplied interactively
  * ---------------------------------------------------------------
  */
+{
+  rngStream r;
+
+  PutSeedStream(&r, x);
+  seed[stream] = r.seed;
+}
+
+
+   void PutSeedStream(rngStream *r, long x)
+/* ---------------------------------------------------------------
+ * Set the state of the caller's stream r, with the same conventions
+ * as PutSeed.
+ * ---------------------------------------------------------------
+ */
 {
   char ok = 0;
 
@@ -122,7 +213,54 @@ static int  initialized   = 0;          /* test for stream initialization */
       if (!ok)
         printf("\nInput out of range ... try again\n");
     }
-  seed[stream] = x;
+  r->engine = RNG_LEHMER;
+  r->seed   = x;
+}
+
+
+   void SeedStream(rngStream *r, int engine, long x)
+/* ---------------------------------------------------------------
+ * Start the caller's stream r on the given engine.  RNG_LEHMER
+ * follows the PutSeed conventions; RNG_SPLITMIX takes x as is.
+ * ---------------------------------------------------------------
+ */
+{
+  if (engine == RNG_SPLITMIX) {
+    r->engine = RNG_SPLITMIX;
+    r->seed   = DEFAULT;
+    r->x      = (unsigned long long) x;
+  }
+  else {
+    PutSeedStream(r, x);
+    r->x      = 0;
+  }
+}
+
+
+   void PlantSeedsStream(rngStream *r, int n, int engine, long x)
+/* ---------------------------------------------------------------------
+ * Reentrant PlantSeeds for the caller's streams r[0] .. r[n-1]: r[0]
+ * is started with SeedStream(r, engine, x) and each later stream is
+ * the one before it jumped ahead, by 8,367,782 draws on RNG_LEHMER
+ * (as PlantSeeds does) or by 2^40 draws on RNG_SPLITMIX.
+ * ---------------------------------------------------------------------
+ */
+{
+  const long Q = MODULUS / A256;
+  const long R = MODULUS % A256;
+        long t;
+        int  j;
+
+  SeedStream(&r[0], engine, x);
+  for (j = 1; j < n; j++) {
+    r[j] = r[j - 1];
+    if (engine == RNG_SPLITMIX)
+      r[j].x += 0x9E3779B97F4A7C15ULL << 40;
+    else {
+      t = A256 * (r[j - 1].seed % Q) - R * (r[j - 1].seed / Q);
+      r[j].seed = (t > 0) ? t : t + MODULUS;
+    }
+  }
 }
 
 
@@ -9,6 +9,15 @@
 #if !defined( _RNGS_ )
 #define _RNGS_
 
+#define RNG_LEHMER   0       /* the generator below, bit-exact with Random */
+#define RNG_SPLITMIX 1       /* 64-bit SplitMix, no divides or floats     */
+
+typedef struct {
+  int  engine;                /* RNG_LEHMER or RNG_SPLITMIX               */
+  long seed;                  /* Lehmer state, 0 < seed < 2^31 - 1        */
+  unsigned long long x;       /* SplitMix state, any value                */
+} rngStream;
+
 double Random(void);
 void   PlantSeeds(long x);
 void   GetSeed(long *x);
@@ -16,4 +25,11 @@ void   PutSeed(long x);
 void   SelectStream(int index);
 void   TestRandom(void);
 
+/* Reentrant versions for callers that keep their own stream */
+double RandomStream(rngStream *r);
+int    RandomBelow(rngStream *r, int n);
+void   PutSeedStream(rngStream *r, long x);
+void   SeedStream(rngStream *r, int engine, long x);
+void   PlantSeedsStream(rngStream *r, int n, int engine, long x);
+
 #endif
@@ -0,0 +1,298 @@
+/* Headless batch simulator
+
+   Plays every seed in a range between two registered strategies,
+   spread over several threads, and prints win/tie rates and average
+   game length.  Nothing is printed per action.
+
+   ./simulate <firstSeed> <lastSeed> <threads> <strategy0> <strategy1> [fast] [legacy] [crn]
+              [iterations=<n>] [seconds=<s>] [batch]
+
+   Seeds must be positive.  iterations and seconds set the mcts
+   strategy's budget per decision.  batch plays treasure-only strategies
+   on the batch engine (batch.h), BATCH_GAMES games at a time, instead of
+   one seed per game; it cannot be combined with fast, legacy or crn.
+   Any other argument prints the usage.
+*/
+
+#include "dominion.h"
+#include "strategy.h"
+#include "mcts.h"
+#include "batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+
+//games still going after this many turns are counted as unfinished
+#define MAX_TURNS 1000
+
+#define MAX_THREADS 256
+
+#define BATCH_GAMES 4096
+
+#define MAX_SEED (INT_MAX - 1)
+
+//what the "mcts" strategy searches with, set from the arguments before
+//any game starts
+static struct mctsConfig mctsConfig;
+static struct strategy mcts;
+
+struct results {
+  long games;
+  long wins[2];          //outright wins for each seat
+  long ties;
+  long unfinished;
+  long turns;            //summed over finished games
+};
+
+struct job {
+  int thread;
+  int numThreads;
+  int firstSeed;
+  int lastSeed;
+  int options;
+  const struct strategy *strategy[2];
+  const struct batchBot *batchBot[2];   //both set to use the batch engine
+  struct results results;
+};
+
+static void playGame(int seed, struct job *job) {
+  struct gameState G;
+  struct botMemory mem[2];
+  int winners[MAX_PLAYERS];
+  int turns = 0;
+  int k[10] = {adventurer, gardens, embargo, village, minion, mine, cutpurse,
+	       sea_hag, tribute, smithy};
+
+  memset(mem, 0, sizeof(mem));
+  if (initializeGameOpts(2, k, seed, job->options, &G) < 0)
+    return;
+
+  while (!isGameOver(&G) && turns < MAX_TURNS) {
+    playStrategyTurn(job->strategy[whoseTurn(&G)], &mem[whoseTurn(&G)], &G, NULL);
+    turns++;
+  }
+
+  job->results.games++;
+  if (turns >= MAX_TURNS) {
+    job->results.unfinished++;
+    return;
+  }
+
+  job->results.turns += turns;
+  getWinners(winners, &G);
+  if (winners[0] && winners[1])
+    job->results.ties++;
+  else if (winners[0])
+    job->results.wins[0]++;
+  else
+    job->results.wins[1]++;
+}
+
+//the seeds from first on, BATCH_GAMES of them at most, as one batch
+static void playBatchGames(long first, struct job *job) {
+  struct batchGames b;
+  const struct batchBot *bots[2];
+  int winners[MAX_PLAYERS];
+  int numGames = job->lastSeed - first + 1 < BATCH_GAMES ? job->lastSeed - first + 1 : BATCH_GAMES;
+  int g;
+
+  if (initBatch(&b, numGames, 2, first) < 0)
+    return;
+  bots[0] = job->batchBot[0];
+  bots[1] = job->batchBot[1];
+  playBatch(&b, bots, MAX_TURNS);
+
+  for (g = 0; g < numGames; g++) {
+    job->results.games++;
+    if (b.turns[g] == 0) {
+      job->results.unfinished++;
+      continue;
+    }
+
+    job->results.turns += b.turns[g];
+    batchWinners(&b, g, winners);
+    if (winners[0] && winners[1])
+      job->results.ties++;
+    else if (winners[0])
+      job->results.wins[0]++;
+    else
+      job->results.wins[1]++;
+  }
+
+  freeBatch(&b);
+}
+
+static void *runJob(void *arg) {
+  struct job *job = arg;
+  long seed;
+
+  if (job->batchBot[0] != NULL) {
+    for (seed = (long) job->firstSeed + (long) job->thread * BATCH_GAMES; seed <= job->lastSeed;
+	 seed += (long) job->numThreads * BATCH_GAMES) {
+      playBatchGames(seed, job);
+    }
+    return NULL;
+  }
+
+  //threads take seeds round robin, so the totals do not depend on timing
+  for (seed = (long) job->firstSeed + job->thread; seed <= job->lastSeed;
+       seed += job->numThreads) {
+    playGame((int) seed, job);
+  }
+
+  return NULL;
+}
+
+static int usage(void) {
+  int i;
+
+  printf("Usage: simulate <firstSeed> <lastSeed> <threads> <strategy0> <strategy1> [fast] [legacy] [crn] [iterations=<n>] [seconds=<s>] [batch]\n");
+  printf("Strategies:");
+  for (i = 0; i < numStrategies(); i++)
+    printf(" %s", getStrategy(i)->name);
+  printf("\n");
+  return EXIT_FAILURE;
+}
+
+//the whole of s as a number from low to high, or -1 if it is not one
+static int parseNumber(const char *s, long low, long high, long *value) {
+  char *end;
+
+  errno = 0;
+  *value = strtol(s, &end, 10);
+  if (end == s || *end != '\0' || errno != 0 || *value < low || *value > high)
+    return -1;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  struct job jobs[MAX_THREADS];
+  pthread_t threads[MAX_THREADS];
+  struct results total;
+  long firstSeed, lastSeed, number;
+  double seconds;
+  char *end;
+  int numThreads;
+  int options = 0;
+  int batch = 0;
+  int i;
+
+  mctsDefaults(&mctsConfig);
+  mcts = mctsStrategy;
+  mcts.config = &mctsConfig;
+  registerStrategy(&mcts);
+
+  if (argc < 6)
+    return usage();
+
+  //a seed of 0 (or 2^31 - 1, which the generator takes as 0) asks for
+  //one on stdin and a negative one reads the clock, so only these give
+  //repeatable games
+  if (parseNumber(argv[1], 1, MAX_SEED, &firstSeed) < 0 ||
+      parseNumber(argv[2], firstSeed, MAX_SEED, &lastSeed) < 0) {
+    printf("seeds must be between 1 and %d, the first no larger than the last\n", MAX_SEED);
+    return EXIT_FAILURE;
+  }
+  if (parseNumber(argv[3], 1, MAX_THREADS, &number) < 0) {
+    printf("threads must be between 1 and %d\n", MAX_THREADS);
+    return EXIT_FAILURE;
+  }
+  numThreads = (int) number;
+
+  for (i = 6; i < argc; i++) {
+    if (strcmp(argv[i], "fast") == 0)
+      options |= GAME_FAST_RNG;
+    else if (strcmp(argv[i], "legacy") == 0)
+      options |= GAME_LEGACY_SHUFFLE;
+    else if (strcmp(argv[i], "crn") == 0)
+      options |= GAME_CRN;
+    else if (strncmp(argv[i], "iterations=", 11) == 0) {
+      if (parseNumber(argv[i] + 11, 0, INT_MAX, &number) < 0) {
+	printf("iterations must be a number, 0 for no limit\n");
+	return EXIT_FAILURE;
+      }
+      mctsConfig.iterations = (int) number;
+    }
+    else if (strncmp(argv[i], "seconds=", 8) == 0) {
+      seconds = strtod(argv[i] + 8, &end);
+      if (end == argv[i] + 8 || *end != '\0' || !(seconds >= 0)) {
+	printf("seconds must be a number, 0 for no time limit\n");
+	return EXIT_FAILURE;
+      }
+      mctsConfig.seconds = seconds;
+    }
+    else if (strcmp(argv[i], "batch") == 0)
+      batch = 1;
+    else
+      return usage();
+  }
+
+  if (mctsConfig.iterations == 0 && mctsConfig.seconds == 0) {
+    printf("mcts needs iterations or seconds\n");
+    return EXIT_FAILURE;
+  }
+
+  //the batch engine has one random stream per game and no shuffle
+  //options of its own
+  if (batch && options != 0) {
+    printf("batch plays its own games and takes none of fast, legacy or crn\n");
+    return EXIT_FAILURE;
+  }
+
+  memset(jobs, 0, sizeof(jobs));
+  for (i = 0; i < numThreads; i++) {
+    jobs[i].thread = i;
+    jobs[i].numThreads = numThreads;
+    jobs[i].firstSeed = (int) firstSeed;
+    jobs[i].lastSeed = (int) lastSeed;
+    jobs[i].options = options;
+    jobs[i].strategy[0] = findStrategy(argv[4]);
+    jobs[i].strategy[1] = findStrategy(argv[5]);
+    if (jobs[i].strategy[0] == NULL || jobs[i].strategy[1] == NULL) {
+      printf("Unknown strategy\n");
+      return EXIT_FAILURE;
+    }
+    if (batch) {
+      jobs[i].batchBot[0] = findBatchBot(argv[4]);
+      jobs[i].batchBot[1] = findBatchBot(argv[5]);
+      if (jobs[i].batchBot[0] == NULL || jobs[i].batchBot[1] == NULL) {
+	printf("batch needs treasure-only strategies\n");
+	return EXIT_FAILURE;
+      }
+    }
+  }
+
+  for (i = 0; i < numThreads; i++) {
+    if (pthread_create(&threads[i], NULL, runJob, &jobs[i]) != 0) {
+      printf("Could not start thread %d\n", i);
+      return EXIT_FAILURE;
+    }
+  }
+
+  memset(&total, 0, sizeof(total));
+  for (i = 0; i < numThreads; i++) {
+    pthread_join(threads[i], NULL);
+    total.games += jobs[i].results.games;
+    total.wins[0] += jobs[i].results.wins[0];
+    total.wins[1] += jobs[i].results.wins[1];
+    total.ties += jobs[i].results.ties;
+    total.unfinished += jobs[i].results.unfinished;
+    total.turns += jobs[i].results.turns;
+  }
+
+  printf("games %ld\n", total.games);
+  if (total.games > 0) {
+    printf("%s (player 0) wins %.4f\n", argv[4], (double) total.wins[0] / total.games);
+    printf("%s (player 1) wins %.4f\n", argv[5], (double) total.wins[1] / total.games);
+    printf("ties %.4f\n", (double) total.ties / total.games);
+    printf("unfinished %.4f\n", (double) total.unfinished / total.games);
+  }
+  if (total.games > total.unfinished) {
+    printf("average turns %.2f\n", (double) total.turns / (total.games - total.unfinished));
+  }
+
+  return EXIT_SUCCESS;
+}
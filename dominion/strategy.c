@@ -0,0 +1,179 @@
+/* 	Bot strategies and the turn driver that runs them
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "interface.h"
+#include "strategy.h"
+
+
+//hand position of the last copy of card in hand, -1 if none
+static int lastInHand(int card, struct gameState *state) {
+  int i;
+  int pos = -1;
+
+  for (i = 0; i < numHandCards(state); i++) {
+    if (handCard(i, state) == card)
+      pos = i;
+  }
+  return pos;
+}
+
+
+//card has a pile in this game with cards left and money covers it
+static int canBuy(int card, int money, struct gameState *state) {
+  return money >= getCost(card) && supplyPile(card, state) >= 0 &&
+    supplyCount(card, state) > 0;
+}
+
+
+//playdom's player 0: Smithy when it has one, at most two Smithies
+static int smithyAction(struct gameState *state, struct botMemory *mem,
+			int *choice1, int *choice2, int *choice3) {
+  return lastInHand(smithy, state);
+}
+
+static int smithyBuy(struct gameState *state, struct botMemory *mem, int money) {
+  if (canBuy(province, money, state))
+    return province;
+  if (canBuy(gold, money, state))
+    return gold;
+  if (canBuy(smithy, money, state) && mem->bought[smithy] < 2)
+    return smithy;
+  if (canBuy(silver, money, state))
+    return silver;
+  if (canBuy(duchy, money, state))
+    return duchy;
+  return -1;
+}
+
+
+//playdom's player 1: Adventurer when it has one, at most two Adventurers
+static int adventurerAction(struct gameState *state, struct botMemory *mem,
+			    int *choice1, int *choice2, int *choice3) {
+  return lastInHand(adventurer, state);
+}
+
+static int adventurerBuy(struct gameState *state, struct botMemory *mem, int money) {
+  if (canBuy(province, money, state))
+    return province;
+  if (canBuy(adventurer, money, state) && mem->bought[adventurer] < 2)
+    return adventurer;
+  if (canBuy(gold, money, state))
+    return gold;
+  if (canBuy(silver, money, state))
+    return silver;
+  if (canBuy(duchy, money, state))
+    return duchy;
+  return -1;
+}
+
+
+//the interface's bot: money only
+static int bigMoneyBuy(struct gameState *state, struct botMemory *mem, int money) {
+  if (canBuy(province, money, state))
+    return province;
+  if (supplyCount(province, state) == 0 && canBuy(duchy, money, state))
+    return duchy;
+  if (canBuy(gold, money, state))
+    return gold;
+  if (canBuy(silver, money, state))
+    return silver;
+  return -1;
+}
+
+
+static const struct strategy builtins[] = {
+  {"smithy", smithyAction, NULL, smithyBuy},
+  {"adventurer", adventurerAction, NULL, adventurerBuy},
+  {"bigmoney", NULL, NULL, bigMoneyBuy},
+};
+
+static const struct strategy *registry[MAX_STRATEGIES] = {
+  &builtins[0], &builtins[1], &builtins[2]
+};
+
+static int registered = sizeof(builtins) / sizeof(builtins[0]);
+
+
+int registerStrategy(const struct strategy *s) {
+  if (registered >= MAX_STRATEGIES || findStrategy(s->name) != NULL)
+    return -1;
+
+  registry[registered] = s;
+  return registered++;
+}
+
+const struct strategy *findStrategy(const char *name) {
+  int i;
+
+  for (i = 0; i < registered; i++) {
+    if (strcmp(registry[i]->name, name) == 0)
+      return registry[i];
+  }
+  return NULL;
+}
+
+int numStrategies(void) {
+  return registered;
+}
+
+const struct strategy *getStrategy(int index) {
+  if (index < 0 || index >= registered)
+    return NULL;
+  return registry[index];
+}
+
+
+int playStrategyTurn(const struct strategy *s, struct botMemory *mem,
+		     struct gameState *state, FILE *trace) {
+  int player = whoseTurn(state);
+  int choice1, choice2, choice3;
+  int pos, card, money;
+  char name[MAX_STRING_LENGTH];
+
+  mem->player = player;
+  mem->config = s->config;
+
+  //action phase
+  while (s->action != NULL && state->numActions > 0) {
+    choice1 = choice2 = choice3 = -1;
+    pos = s->action(state, mem, &choice1, &choice2, &choice3);
+    if (pos < 0 || pos >= numHandCards(state))
+      break;
+
+    card = handCard(pos, state);
+    if (playCard(pos, choice1, choice2, choice3, state) < 0)
+      break;
+    if (trace != NULL) {
+      cardNumToName(card, name);
+      fprintf(trace, "%d: played %s from position %d\n", player, name, pos);
+    }
+  }
+
+  //treasure phase
+  money = (s->treasure != NULL) ? s->treasure(state, mem) : state->coins;
+
+  //buy phase
+  while (s->buy != NULL && state->numBuys > 0) {
+    card = s->buy(state, mem, money);
+    if (card < curse || card >= numCards())
+      break;
+
+    mem->bought[card]++;
+    if (buyCard(card, state) < 0)
+      break;
+    if (trace != NULL) {
+      cardNumToName(card, name);
+      fprintf(trace, "%d: bought %s\n", player, name);
+    }
+    money -= getCost(card);
+  }
+
+  if (trace != NULL)
+    fprintf(trace, "%d: end turn\n", player);
+
+  return endTurn(state);
+}
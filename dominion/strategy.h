@@ -0,0 +1,64 @@
+/* 	Bot strategies
+
+	A strategy is a set of callbacks the engine asks for decisions.
+	Strategies are registered under a name, so simulators can pick
+	them at run time.
+*/
+
+#ifndef _STRATEGY_H
+#define _STRATEGY_H
+
+#include <stdio.h>
+#include "dominion.h"
+
+#define MAX_STRATEGIES 64
+
+/* What a bot remembers over one game, zero it before the game starts */
+struct botMemory {
+  int player;
+  int bought[MAX_CARDS]; /* buy attempts of each card so far */
+  void *data;                 /* for the strategy's own use */
+  const void *config;         /* the strategy's config, set by playStrategyTurn */
+};
+
+struct strategy {
+  const char *name;
+
+  int (*action)(struct gameState *state, struct botMemory *mem,
+		int *choice1, int *choice2, int *choice3);
+  /* Hand position of the next action card to play, with its choices,
+     or -1 to end the action phase.  NULL never plays actions */
+
+  int (*treasure)(struct gameState *state, struct botMemory *mem);
+  /* Coins to take into the buy phase.  The engine counts every treasure
+     in hand for you (state->coins), so most bots return that.  NULL
+     means state->coins */
+
+  int (*buy)(struct gameState *state, struct botMemory *mem, int money);
+  /* Supply position of the next card to buy with money left, or -1 to
+     stop buying.  NULL never buys */
+
+  const void *config;
+  /* Settings the callbacks read through mem->config, NULL for none.
+     Only read, so games on other threads can share it; registering
+     copies of one strategy with different configs gives bots that
+     play the same way with different settings */
+};
+
+int registerStrategy(const struct strategy *s);
+/* Add s to the registry, s must stay valid.  Returns its index or -1 if
+   the registry is full or the name is taken */
+
+const struct strategy *findStrategy(const char *name);
+/* NULL if no strategy has that name */
+
+int numStrategies(void);
+
+const struct strategy *getStrategy(int index);
+
+int playStrategyTurn(const struct strategy *s, struct botMemory *mem,
+		     struct gameState *state, FILE *trace);
+/* Play the current player's whole turn with s and end it.  Each play
+   and buy is written to trace unless it is NULL */
+
+#endif
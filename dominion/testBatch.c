@@ -0,0 +1,147 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "strategy.h"
+#include "batch.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "rngs.h"
+
+#define GAMES 4000
+#define BATCH 20000
+#define MAX_TURNS 1000
+
+struct tally {
+  double wins;    //seat 0 alone
+  double ties;
+  double turns;
+};
+
+//every card is still somewhere, and hands are full
+void checkCards(struct batchGames *b) {
+  int start[BATCH_CARDS];
+  int g, c, p, n, inHand;
+
+  for (g = 0; g < b->numGames; g++) {
+    start[curse] = 10 * (b->numPlayers - 1);
+    start[estate] = (b->numPlayers == 2 ? 8 : 12) + 3 * b->numPlayers;
+    start[duchy] = start[province] = b->numPlayers == 2 ? 8 : 12;
+    start[copper] = 60;
+    start[silver] = 40;
+    start[gold] = 30;
+    for (c = 0; c < BATCH_CARDS; c++) {
+      n = b->supply[c][g];
+      assert(n >= 0);
+      for (p = 0; p < b->numPlayers; p++) {
+	assert(b->deck[p][c][g] >= 0 && b->hand[p][c][g] >= 0 && b->discard[p][c][g] >= 0);
+	n += b->deck[p][c][g] + b->hand[p][c][g] + b->discard[p][c][g];
+      }
+      assert(n == start[c]);
+    }
+    for (p = 0; p < b->numPlayers; p++) {
+      inHand = 0;
+      for (c = 0; c < BATCH_CARDS; c++)
+	inHand += b->hand[p][c][g];
+      assert(inHand == 5);
+    }
+  }
+}
+
+int main () {
+
+  int g, turns, numPlayers;
+  int winners[MAX_PLAYERS];
+  int k[10] = {adventurer, council_room, feast, gardens, mine, remodel,
+	       smithy, village, baron, great_hall};
+  const struct batchBot *bots[MAX_PLAYERS];
+  struct botMemory mem[2];
+  struct batchGames b, small;
+  struct tally one, many;
+  struct gameState G;
+
+  printf ("Testing the batch engine.\n");
+
+  bots[0] = bots[1] = bots[2] = bots[3] = findBatchBot("bigmoney");
+  assert(bots[0] != NULL);
+  assert(findBatchBot("smithy") == NULL);
+  assert(initBatch(&b, 0, 2, 1) == -1);
+  assert(initBatch(&b, 10, 5, 1) == -1);
+
+  printf ("CARDS.\n");
+
+  for (numPlayers = 2; numPlayers <= 4; numPlayers++) {
+    assert(initBatch(&b, 500, numPlayers, numPlayers) == 0);
+    checkCards(&b);
+    while (playBatchTurn(&b, bots[0]) > 0 && b.turn < MAX_TURNS)
+      checkCards(&b);
+    checkCards(&b);
+    freeBatch(&b);
+  }
+
+  printf ("GAMES DO NOT DEPEND ON THE BATCH SIZE.\n");
+
+  assert(initBatch(&b, 300, 2, 7) == 0);
+  assert(initBatch(&small, 100, 2, 7) == 0);
+  playBatch(&b, bots, MAX_TURNS);
+  playBatch(&small, bots, MAX_TURNS);
+  for (g = 0; g < 100; g++) {
+    assert(b.turns[g] == small.turns[g]);
+    assert(batchScore(&b, g, 0) == batchScore(&small, g, 0));
+    assert(batchScore(&b, g, 1) == batchScore(&small, g, 1));
+  }
+  freeBatch(&b);
+  freeBatch(&small);
+
+  //nor on where the batch starts: game g of the batch from seed 7 is
+  //the first game of the batch from seed 7 + g
+  assert(initBatch(&b, 50, 2, 7) == 0);
+  playBatch(&b, bots, MAX_TURNS);
+  for (g = 0; g < 50; g += 7) {
+    assert(initBatch(&small, 1, 2, 7 + g) == 0);
+    playBatch(&small, bots, MAX_TURNS);
+    assert(b.turns[g] == small.turns[0]);
+    assert(batchScore(&b, g, 0) == batchScore(&small, 0, 0));
+    assert(batchScore(&b, g, 1) == batchScore(&small, 0, 1));
+    freeBatch(&small);
+  }
+  freeBatch(&b);
+
+  printf ("AGAINST THE FULL ENGINE.\n");
+
+  //bigmoney against itself both ways
+  memset(&one, 0, sizeof(one));
+  for (g = 0; g < GAMES; g++) {
+    initializeGame(2, k, g + 1, &G);
+    memset(mem, 0, sizeof(mem));
+    for (turns = 0; turns < MAX_TURNS && !isGameOver(&G); turns++)
+      playStrategyTurn(findStrategy("bigmoney"), &mem[whoseTurn(&G)], &G, NULL);
+    getWinners(winners, &G);
+    one.wins += winners[0] && !winners[1];
+    one.ties += winners[0] && winners[1];
+    one.turns += turns;
+  }
+
+  memset(&many, 0, sizeof(many));
+  assert(initBatch(&b, BATCH, 2, 1) == 0);
+  assert(playBatch(&b, bots, MAX_TURNS) == 0);
+  for (g = 0; g < BATCH; g++) {
+    batchWinners(&b, g, winners);
+    many.wins += winners[0] && !winners[1];
+    many.ties += winners[0] && winners[1];
+    many.turns += b.turns[g];
+  }
+  freeBatch(&b);
+
+  printf ("wins %.4f %.4f, ties %.4f %.4f, turns %.2f %.2f\n",
+	  one.wins / GAMES, many.wins / BATCH, one.ties / GAMES, many.ties / BATCH,
+	  one.turns / GAMES, many.turns / BATCH);
+  assert(fabs(one.wins / GAMES - many.wins / BATCH) < 0.04);
+  assert(fabs(one.ties / GAMES - many.ties / BATCH) < 0.02);
+  assert(fabs(one.turns / GAMES - many.turns / BATCH) < 0.5);
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
@@ -8,6 +8,15 @@
 #define DEBUG 0
 #define NOISY_TEST 1
 
+int coinValue(int pile, struct gameState *G) {
+  int card = pileCard(pile, G);
+
+  if (card == copper) return 1;
+  if (card == silver) return 2;
+  if (card == gold) return 3;
+  return 0;
+}
+
 int checkDrawCard(int p, struct gameState *post) {
   struct gameState pre;
   memcpy (&pre, post, sizeof(struct gameState));
@@ -24,15 +33,20 @@ int checkDrawCard(int p, struct gameState *post) {
   if (pre.deckCount[p] > 0) {
     pre.handCount[p]++;
     pre.hand[p][pre.handCount[p]-1] = pre.deck[p][pre.deckCount[p]-1];
+    pre.handCoins[p] += coinValue(pre.hand[p][pre.handCount[p]-1], &pre);
     pre.deckCount[p]--;
   } else if (pre.discardCount[p] > 0) {
-    memcpy(pre.deck[p], post->deck[p], sizeof(int) * pre.discardCount[p]);
-    memcpy(pre.discard[p], post->discard[p], sizeof(int)*pre.discardCount[p]);
+    memcpy(pre.deck[p], post->deck[p], sizeof(card_t) * pre.discardCount[p]);
+    memcpy(pre.discard[p], post->discard[p], sizeof(card_t)*pre.discardCount[p]);
     pre.hand[p][post->handCount[p]-1] = post->hand[p][post->handCount[p]-1];
+    pre.handCoins[p] += coinValue(pre.hand[p][post->handCount[p]-1], &pre);
     pre.handCount[p]++;
     pre.deckCount[p] = pre.discardCount[p]-1;
     pre.discardCount[p] = 0;
+    pre.rng = post->rng; //the reshuffle draws from the game's stream
+    pre.deckRng[p] = post->deckRng[p]; //or the player's, under GAME_CRN
   }
+  pre.pileHash[p] = post->pileHash[p]; //testHashGameState checks the hash
 
   assert (r == 0);
 
@@ -60,6 +74,7 @@ int main () {
     for (i = 0; i < sizeof(struct gameState); i++) {
       ((char*)&G)[i] = floor(Random() * 256);
     }
+    G.undo = NULL; //random bytes are no log to record into
     p = floor(Random() * 2);
     G.deckCount[p] = floor(Random() * MAX_DECK);
     G.discardCount[p] = floor(Random() * MAX_DECK);
@@ -79,11 +94,11 @@ int main () {
 	  memset(&G, 23, sizeof(struct gameState)); 
 	  r = initializeGame(2, k, 1, &G);
 	  G.deckCount[p] = deckCount;
-	  memset(G.deck[p], 0, sizeof(int) * deckCount);
+	  memset(G.deck[p], 0, sizeof(card_t) * deckCount);
 	  G.discardCount[p] = discardCount;
-	  memset(G.discard[p], 0, sizeof(int) * discardCount);
+	  memset(G.discard[p], 0, sizeof(card_t) * discardCount);
 	  G.handCount[p] = handCount;
-	  memset(G.hand[p], 0, sizeof(int) * handCount);
+	  memset(G.hand[p], 0, sizeof(card_t) * handCount);
 	  checkDrawCard(p, &G);
 	}
       }
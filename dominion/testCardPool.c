@@ -0,0 +1,279 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "interface.h"
+#include "moves.h"
+#include "strategy.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "rngs.h"
+
+#define FILLERS 200
+
+int scanCount(int p, int card, struct gameState *G) {
+  int i;
+  int count = 0;
+
+  for (i = 0; i < G->deckCount[p]; i++)
+    if (pileCard(G->deck[p][i], G) == card) count++;
+  for (i = 0; i < G->handCount[p]; i++)
+    if (pileCard(G->hand[p][i], G) == card) count++;
+  for (i = 0; i < G->discardCount[p]; i++)
+    if (pileCard(G->discard[p][i], G) == card) count++;
+
+  return count;
+}
+
+//counts kept as cards move match a rebuild from the piles
+void checkCounts(struct gameState *G) {
+  struct gameState G2;
+  int p, i;
+
+  for (p = 0; p < G->numPlayers; p++)
+    for (i = 0; i < G->numPiles; i++)
+      assert(fullDeckCount(p, G->supplyCard[i], G) == scanCount(p, G->supplyCard[i], G));
+
+  memcpy(&G2, G, sizeof(struct gameState));
+  rehashGameState(&G2);
+  assert(hashGameState(&G2) == hashGameState(G));
+  assert(G2.emptyPiles == G->emptyPiles);
+}
+
+//cards left in the supply
+int supplyLeft(struct gameState *G) {
+  int i;
+  int left = 0;
+
+  for (i = 0; i < G->numPiles; i++)
+    left += G->pileCount[i];
+  return left;
+}
+
+//put card in player 0's hand and play it
+int playFromHand(int card, struct gameState *G) {
+  gainCard(card, G, 2, 0);
+  return playCard(numHandCards(G) - 1, 0, 0, 0, G);
+}
+
+int main () {
+
+  int i, n, game, step, pool;
+  int k[MAX_KINGDOM + 1];
+  int lab, festival, platinum, colony, filler;
+  int hand, coins, score, highest, tried, left;
+  struct botMemory mem[MAX_PLAYERS];
+  char name[MAX_STRING_LENGTH];
+  struct cardInfo info;
+  struct move moves[MAX_MOVES];
+  struct gameState G;
+  FILE *file;
+
+  printf ("Testing the card pool.\n");
+
+  printf ("BUILT-IN CARDS.\n");
+
+  assert(numCards() == treasure_map + 1);
+  assert(getCost(province) == 8 && getCost(treasure_map) == 4);
+  assert(getCost(treasure_map + 1) == -1 && getCardInfo(-1) == NULL);
+  assert(getCardInfo(gold)->coins == 3 && getCardInfo(gold)->types == CARD_TREASURE);
+  assert(getCardInfo(great_hall)->types == (CARD_ACTION | CARD_VICTORY));
+  cardNumToName(sea_hag, name);
+  assert(strcmp(name, "Sea Hag") == 0);
+
+  printf ("ADDED CARDS.\n");
+
+  memset(&info, 0, sizeof(info));
+  info.name = "Laboratory";
+  info.cost = 5;
+  info.types = CARD_ACTION;
+  info.plusCards = 2;
+  info.plusActions = 1;
+  lab = addCard(&info);
+  assert(lab == treasure_map + 1);
+
+  info.name = "Festival";
+  info.plusCards = 0;
+  info.plusActions = 2;
+  info.plusBuys = 1;
+  info.plusCoins = 2;
+  festival = addCard(&info);
+
+  memset(&info, 0, sizeof(info));
+  info.name = "Platinum";
+  info.cost = 9;
+  info.types = CARD_TREASURE;
+  info.coins = 5;
+  platinum = addCard(&info);
+
+  info.name = "Colony";
+  info.cost = 11;
+  info.types = CARD_VICTORY;
+  info.coins = 0;
+  info.vp = 10;
+  colony = addCard(&info);
+
+  //enough cards that ids no longer fit in a byte
+  memset(&info, 0, sizeof(info));
+  info.name = "Filler";
+  info.cost = 2;
+  info.types = CARD_ACTION;
+  info.plusCards = 1;
+  info.plusActions = 1;
+  for (i = 0; i < FILLERS; i++)
+    assert(addCard(&info) == colony + 1 + i);
+  filler = numCards() - 1;
+  assert(filler > 127);
+  cardNumToName(filler, name);
+  assert(strcmp(name, "Filler") == 0);
+
+  //loaded from a file as well
+  file = fopen("testCardPool.pool", "w");
+  fprintf(file, "# name, cost, types, coins, vp, +cards, +actions, +buys, +coins\n\n");
+  fprintf(file, "Market, 5, action, 0, 0, 1, 1, 1, 1\n");
+  fprintf(file, "Harem, 6, treasure|victory, 2, 2, 0, 0, 0, 0\n");
+  fclose(file);
+  pool = numCards();
+  assert(loadCardPool("testCardPool.pool") == 2);
+  assert(numCards() == pool + 2);
+  assert(getCost(pool) == 5 && getCardInfo(pool)->plusBuys == 1);
+  assert(getCardInfo(pool + 1)->types == (CARD_TREASURE | CARD_VICTORY));
+  cardNumToName(pool + 1, name);
+  assert(strcmp(name, "Harem") == 0);
+
+  file = fopen("testCardPool.pool", "w");
+  fprintf(file, "Bridge, 4, action, 0, 0, 0, 0, 1, 1\n");
+  fprintf(file, "Bridge Troll, 5, action|troll, 0, 0, 0, 0, 1, 0\n");
+  fclose(file);
+  assert(loadCardPool("testCardPool.pool") == -1);
+  assert(loadCardPool("no such file") == -1);
+  remove("testCardPool.pool");
+
+  printf ("SUPPLY.\n");
+
+  //every kingdom size up to MAX_KINGDOM, added cards among them
+  k[0] = lab;
+  k[1] = festival;
+  k[2] = platinum;
+  k[3] = colony;
+  k[4] = filler;
+  k[5] = smithy;
+  k[6] = gardens;
+  for (i = 7; i <= MAX_KINGDOM; i++)
+    k[i] = lab + 4 + i;
+  assert(initializeGameSupply(2, k, MAX_KINGDOM + 1, 1, 0, &G) == -1);
+  k[3] = lab;
+  assert(initializeGameSupply(2, k, 4, 1, 0, &G) == -1);
+  k[3] = copper;
+  assert(initializeGameSupply(2, k, 4, 1, 0, &G) == -1);
+  k[3] = numCards();
+  assert(initializeGameSupply(2, k, 4, 1, 0, &G) == -1);
+  k[3] = colony;
+
+  for (n = 0; n <= MAX_KINGDOM; n++) {
+    assert(initializeGameSupply(2 + n % 3, k, n, n + 1, 0, &G) == 0);
+    assert(G.numPiles == 7 + n);
+    for (i = 1; i < G.numPiles; i++)
+      assert(G.supplyCard[i-1] < G.supplyCard[i]);
+    for (i = 0; i < n; i++)
+      assert(supplyCount(k[i], &G) == ((getCardInfo(k[i])->types & CARD_VICTORY) ?
+				      (G.numPlayers == 2 ? 8 : 12) : 10));
+    assert(supplyCount(k[n < MAX_KINGDOM ? n : 0], &G) == (n < MAX_KINGDOM ? -1 : 10));
+    assert(supplyCount(adventurer, &G) == -1 && supplyPile(adventurer, &G) == -1);
+    assert(supplyCount(-1, &G) == -1 && supplyCount(MAX_CARDS, &G) == -1);
+    checkCounts(&G);
+  }
+
+  //the pool is frozen once a game is set up
+  pool = numCards();
+  assert(addCard(&info) == -1 && numCards() == pool);
+  file = fopen("testCardPool.pool", "w");
+  fprintf(file, "Market, 5, action, 0, 0, 1, 1, 1, 1\n");
+  fclose(file);
+  assert(loadCardPool("testCardPool.pool") == -1 && numCards() == pool);
+  remove("testCardPool.pool");
+
+  printf ("PLAYING ADDED CARDS.\n");
+
+  initializeGameSupply(2, k, MAX_KINGDOM, 1, 0, &G);
+
+  hand = numHandCards(&G);
+  assert(playFromHand(lab, &G) == 0);
+  assert(numHandCards(&G) == hand + 2 && G.numActions == 1);
+
+  coins = G.coins;
+  assert(playFromHand(festival, &G) == 0);
+  assert(playFromHand(festival, &G) == 0);
+  assert(G.coins == coins + 4 && G.numActions == 3 && G.numBuys == 3);
+
+  //not actions
+  gainCard(platinum, &G, 2, 0);
+  assert(playCard(numHandCards(&G) - 1, 0, 0, 0, &G) == -1);
+  assert(G.handCoins[0] == coins + 5);
+
+  score = scoreFor(0, &G);
+  gainCard(colony, &G, 0, 0);
+  assert(scoreFor(0, &G) == score + 10);
+
+  assert(playFromHand(filler, &G) == 0);
+  checkCounts(&G);
+
+  //nor put in a hand
+  hand = numHandCards(&G);
+  assert(addCardToHand(0, adventurer, &G) == FAILURE && numHandCards(&G) == hand);
+  assert(addCardToHand(0, lab, &G) == SUCCESS && handCard(hand, &G) == lab);
+  checkCounts(&G);
+
+  //a card outside the game cannot be bought
+  G.coins = 20;
+  assert(buyCard(adventurer, &G) == -1);
+  assert(buyCard(filler, &G) == 0);
+
+  printf ("STRATEGIES WITHOUT THEIR CARDS.\n");
+
+  //no Adventurer pile: the bot buys money instead, and every card it
+  //tries to buy is bought
+  for (game = 0; game < 10; game++) {
+    initializeGameSupply(2, k, MAX_KINGDOM, game + 1, 0, &G);
+    assert(supplyPile(adventurer, &G) == -1);
+    memset(mem, 0, sizeof(mem));
+    left = supplyLeft(&G);
+    for (step = 0; step < 200 && !isGameOver(&G); step++) {
+      playStrategyTurn(findStrategy("adventurer"), &mem[whoseTurn(&G)], &G, NULL);
+      for (tried = 0, i = 0; i < MAX_CARDS; i++)
+	tried += mem[0].bought[i] + mem[1].bought[i];
+      assert(tried == left - supplyLeft(&G));
+    }
+    assert(isGameOver(&G));
+    assert(mem[0].bought[adventurer] == 0 && mem[0].bought[silver] > 0);
+  }
+
+  printf ("RANDOM GAMES.\n");
+
+  SelectStream(2);
+  PutSeed(11);
+
+  highest = 0;
+  for (game = 0; game < 100; game++) {
+    assert(selectKingdom(game + 1, k, MAX_KINGDOM) == 0);
+    for (i = 0; i < MAX_KINGDOM; i++)
+      assert(k[i] >= adventurer && k[i] < numCards());
+    assert(initializeGameSupply(2 + game % 3, k, MAX_KINGDOM, game + 1, game % 8, &G) == 0);
+
+    for (step = 0; step < 400 && !isGameOver(&G); step++) {
+      n = legalMoves(&G, moves, MAX_MOVES);
+      assert(n >= 1 && n <= MAX_MOVES);
+      i = floor(Random() * n);
+      if (moves[i].type == MOVE_BUY && moves[i].card > highest)
+	highest = moves[i].card;
+      assert(makeMove(&moves[i], &G) == 0);
+      checkCounts(&G);
+    }
+  }
+  assert(highest > 127);
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "counters.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <assert.h>
+#include "rngs.h"
+
+#define THREADS 4
+#define DRAWS 1000
+
+int k[10] = {adventurer, council_room, feast, gardens, mine, remodel,
+	     smithy, village, baron, great_hall};
+
+//counts made since before
+long since(struct counters *before, int c) {
+  struct counters now;
+
+  totalCounters(&now);
+  return now.count[c] - before->count[c];
+}
+
+void *drawMany(void *arg) {
+  struct gameState G;
+  int i;
+
+  initializeGame(2, k, (int) (long) arg, &G);
+  for (i = 0; i < DRAWS; i++) {
+    if (G.deckCount[whoseTurn(&G)] + G.discardCount[whoseTurn(&G)] == 0)
+      endTurn(&G);
+    assert(drawCard(whoseTurn(&G), &G) == 0);
+  }
+  return NULL;
+}
+
+int main () {
+
+  int i;
+  struct gameState G;
+  struct counters before, after;
+  pthread_t threads[THREADS];
+
+  printf ("Testing the counters.\n");
+
+  initializeGame(2, k, 1, &G);
+
+  printf ("DRAWS AND SHUFFLES.\n");
+
+  totalCounters(&before);
+  assert(drawCard(0, &G) == 0);
+  assert(drawCards(0, 3, &G) == 0);
+  assert(since(&before, COUNT_DRAW_CALL) == 2);
+  assert(since(&before, COUNT_CARDS_DRAWN) == 4);
+  assert(since(&before, COUNT_RESHUFFLE) == 0);
+
+  //the deck has one card left, the rest are in the discard
+  totalCounters(&before);
+  for (i = 0; i < 4; i++)
+    gainCard(copper, &G, 0, 0);
+  assert(drawCards(0, 3, &G) == 0);
+  assert(since(&before, COUNT_CARDS_DRAWN) == 3);
+  assert(since(&before, COUNT_RESHUFFLE) == 1);
+  assert(since(&before, COUNT_SHUFFLE) == 1);
+
+  printf ("PLAYS, BUYS AND GAINS.\n");
+
+  totalCounters(&before);
+  gainCard(smithy, &G, 2, 0);
+  assert(playCard(numHandCards(&G) - 1, 0, 0, 0, &G) == 0);
+  assert(playCard(0, 0, 0, 0, &G) == -1);
+  totalCounters(&after);
+  assert(after.count[COUNT_PLAY_CARD] - before.count[COUNT_PLAY_CARD] == 2);
+  assert(after.count[COUNT_PLAY_CARD_FAILED] - before.count[COUNT_PLAY_CARD_FAILED] == 1);
+  assert(after.gained[smithy] - before.gained[smithy] == 1);
+  assert(after.effects[smithy] - before.effects[smithy] == 1);
+  assert(after.effectCycles[smithy] > before.effectCycles[smithy]);
+
+  totalCounters(&before);
+  G.coins = 3;
+  assert(buyCard(silver, &G) == 0);
+  assert(buyCard(gold, &G) == -1);
+  totalCounters(&after);
+  assert(after.count[COUNT_BUY_CARD] - before.count[COUNT_BUY_CARD] == 2);
+  assert(after.count[COUNT_BUY_CARD_FAILED] - before.count[COUNT_BUY_CARD_FAILED] == 1);
+  assert(after.gained[silver] - before.gained[silver] == 1);
+  assert(after.gained[gold] == before.gained[gold]);
+
+  totalCounters(&before);
+  endTurn(&G);
+  isGameOver(&G);
+  scoreFor(0, &G);
+  updateCoins(1, &G, 0);
+  assert(since(&before, COUNT_END_TURN) == 1);
+  assert(since(&before, COUNT_IS_GAME_OVER) == 1);
+  assert(since(&before, COUNT_SCORE_FOR) == 1);
+  assert(since(&before, COUNT_UPDATE_COINS) >= 1);
+
+  printf ("THREADS.\n");
+
+  //each thread counts on its own, and the totals take in the ones
+  //that have ended
+  totalCounters(&before);
+  for (i = 0; i < THREADS; i++)
+    assert(pthread_create(&threads[i], NULL, drawMany, (void *) (long) (i + 1)) == 0);
+  for (i = 0; i < THREADS; i++)
+    pthread_join(threads[i], NULL);
+  assert(since(&before, COUNT_DRAW_CALL) >= THREADS * DRAWS);
+  assert(since(&before, COUNT_CARDS_DRAWN) >= THREADS * DRAWS);
+  assert(newCounters() == newCounters());
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
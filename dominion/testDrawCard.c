@@ -1,6 +1,7 @@
 #include "dominion.h"
 #include "dominion_helpers.h"
 #include <string.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
 #include "rngs.h"
@@ -8,6 +9,19 @@
 #define DEBUG 0
 #define NOISY_TEST 1
 
+int coinValue(int pile, struct gameState *G) {
+  int card = pileCard(pile, G);
+
+  if (card == copper) return 1;
+  if (card == silver) return 2;
+  if (card == gold) return 3;
+  return 0;
+}
+
+int compareCards(const void *a, const void *b) {
+  return *(const card_t *) a - *(const card_t *) b;
+}
+
 int checkDrawCard(int p, struct gameState *post) {
   struct gameState pre;
   memcpy (&pre, post, sizeof(struct gameState));
@@ -24,15 +38,20 @@ int checkDrawCard(int p, struct gameState *post) {
   if (pre.deckCount[p] > 0) {
     pre.handCount[p]++;
     pre.hand[p][pre.handCount[p]-1] = pre.deck[p][pre.deckCount[p]-1];
+    pre.handCoins[p] += coinValue(pre.hand[p][pre.handCount[p]-1], &pre);
     pre.deckCount[p]--;
   } else if (pre.discardCount[p] > 0) {
-    memcpy(pre.deck[p], post->deck[p], sizeof(int) * pre.discardCount[p]);
-    memcpy(pre.discard[p], post->discard[p], sizeof(int)*pre.discardCount[p]);
+    memcpy(pre.deck[p], post->deck[p], sizeof(card_t) * pre.discardCount[p]);
+    memcpy(pre.discard[p], post->discard[p], sizeof(card_t)*pre.discardCount[p]);
     pre.hand[p][post->handCount[p]-1] = post->hand[p][post->handCount[p]-1];
+    pre.handCoins[p] += coinValue(pre.hand[p][post->handCount[p]-1], &pre);
     pre.handCount[p]++;
     pre.deckCount[p] = pre.discardCount[p]-1;
     pre.discardCount[p] = 0;
+    pre.rng = post->rng; //the reshuffle draws from the game's stream
+    pre.deckRng[p] = post->deckRng[p]; //or the player's, under GAME_CRN
   }
+  pre.pileHash[p] = post->pileHash[p]; //testHashGameState checks the hash
 
   assert (r == 0);
 
@@ -46,7 +65,8 @@ int main () {
   int k[10] = {adventurer, council_room, feast, gardens, mine,
 	       remodel, smithy, village, baron, great_hall};
 
-  struct gameState G;
+  struct gameState G, G2;
+  int j, want;
 
   printf ("Testing drawCard.\n");
 
@@ -59,6 +79,7 @@ int main () {
     for (i = 0; i < sizeof(struct gameState); i++) {
       ((char*)&G)[i] = floor(Random() * 256);
     }
+    G.undo = NULL; //random bytes are no log to record into
     p = floor(Random() * 2);
     G.deckCount[p] = floor(Random() * MAX_DECK);
     G.discardCount[p] = floor(Random() * MAX_DECK);
@@ -66,6 +87,35 @@ int main () {
     checkDrawCard(p, &G);
   }
 
+  //the same cards, in drawn order only in legacy games
+  printf ("DRAWCARDS IS DRAWCARD N TIMES.\n");
+
+  for (n = 0; n < 2000; n++) {
+    for (i = 0; i < sizeof(struct gameState); i++) {
+      ((char*)&G)[i] = floor(Random() * 256);
+    }
+    G.undo = NULL; //random bytes are no log to record into
+    p = floor(Random() * 2);
+    G.deckCount[p] = floor(Random() * 8);
+    G.discardCount[p] = floor(Random() * 8);
+    G.handCount[p] = floor(Random() * (MAX_HAND - 16));
+    memcpy(&G2, &G, sizeof(struct gameState));
+
+    j = floor(Random() * 16);
+    want = 0;
+    for (i = 0; i < j; i++) {
+      if (drawCard(p, &G2) < 0)
+	want = -1;
+    }
+    handCount = G.handCount[p];
+    assert(drawCards(p, j, &G) == want);
+    if (!(G.options & GAME_LEGACY_SHUFFLE)) {
+      qsort(G.hand[p] + handCount, G.handCount[p] - handCount, sizeof(card_t), compareCards);
+      qsort(G2.hand[p] + handCount, G2.handCount[p] - handCount, sizeof(card_t), compareCards);
+    }
+    assert(memcmp(&G, &G2, sizeof(struct gameState)) == 0);
+  }
+
   printf ("ALL TESTS OK\n");
 
   exit(0);
@@ -78,11 +128,11 @@ int main () {
 	  memset(&G, 23, sizeof(struct gameState)); 
 	  r = initializeGame(2, k, 1, &G);
 	  G.deckCount[p] = deckCount;
-	  memset(G.deck[p], 0, sizeof(int) * deckCount);
+	  memset(G.deck[p], 0, sizeof(card_t) * deckCount);
 	  G.discardCount[p] = discardCount;
-	  memset(G.discard[p], 0, sizeof(int) * discardCount);
+	  memset(G.discard[p], 0, sizeof(card_t) * discardCount);
 	  G.handCount[p] = handCount;
-	  memset(G.hand[p], 0, sizeof(int) * handCount);
+	  memset(G.hand[p], 0, sizeof(card_t) * handCount);
 	  checkDrawCard(p, &G);
 	}
       }
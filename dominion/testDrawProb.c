@@ -0,0 +1,201 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "drawprob.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "rngs.h"
+
+#define SIZE 40
+#define TRIALS 20000
+
+//a treasure added with addCard
+static int platinum;
+
+static int coinsOf(int card) {
+  return card == copper ? 1 : card == silver ? 2 : card == gold ? 3 :
+    card == platinum ? 5 : 0;
+}
+
+static int bits(int mask) {
+  int n = 0;
+
+  for (; mask; mask >>= 1)
+    n += mask & 1;
+  return n;
+}
+
+//lay out a pile's counts as cards
+static int spread(const int *count, int *cards) {
+  int card, i;
+  int n = 0;
+
+  for (card = curse; card < numCards(); card++)
+    for (i = 0; i < count[card]; i++)
+      cards[n++] = card;
+  return n;
+}
+
+//every way to draw n off small piles, each equally likely
+void checkExact(struct drawPiles *P, int n, int card) {
+  int deck[16], discard[16];
+  int nDeck = spread(P->deck, deck);
+  int nDiscard = spread(P->discard, discard);
+  int n1 = n < nDeck ? n : nDeck;
+  int n2 = n - n1 < nDiscard ? n - n1 : nDiscard;
+  double want[SIZE], got[SIZE];
+  double ways = 0;
+  double hits[8];
+  int a, b, i, coins, copies;
+
+  memset(want, 0, sizeof(want));
+  memset(hits, 0, sizeof(hits));
+  for (a = 0; a < (1 << nDeck); a++) {
+    if (bits(a) != n1)
+      continue;
+    for (b = 0; b < (1 << nDiscard); b++) {
+      if (bits(b) != n2)
+	continue;
+      coins = copies = 0;
+      for (i = 0; i < nDeck; i++)
+	if (a & (1 << i)) {
+	  coins += coinsOf(deck[i]);
+	  copies += deck[i] == card;
+	}
+      for (i = 0; i < nDiscard; i++)
+	if (b & (1 << i)) {
+	  coins += coinsOf(discard[i]);
+	  copies += discard[i] == card;
+	}
+      want[coins < SIZE - 1 ? coins : SIZE - 1]++;
+      hits[copies]++;
+      ways++;
+    }
+  }
+
+  assert(coinDistribution(P, n, got, SIZE) == 0);
+  for (i = 0; i < SIZE; i++)
+    assert(fabs(got[i] - want[i] / ways) < 1e-9);
+
+  for (i = 7; i > 0; i--)
+    hits[i-1] += hits[i];
+  for (i = 1; i < 8; i++)
+    assert(fabs(probCardsAtLeast(P, n, card, i) - hits[i] / ways) < 1e-9);
+}
+
+int main () {
+
+  int t, i, j, n, card, coins, copies;
+  int hit[2];
+  int mix[6] = {copper, silver, gold, estate, smithy, 0};
+  double p, q, total;
+  double dist[SIZE];
+  struct drawPiles P;
+  struct cardInfo info;
+  struct gameState G, G2;
+
+  int k[10] = {adventurer, council_room, feast, gardens, mine, remodel,
+	       smithy, village, baron, great_hall};
+
+  printf ("Testing draw probabilities.\n");
+
+  //before any game freezes the pool
+  memset(&info, 0, sizeof(info));
+  info.name = "Platinum";
+  info.cost = 9;
+  info.types = CARD_TREASURE;
+  info.coins = 5;
+  platinum = addCard(&info);
+  assert(platinum > treasure_map);
+
+  initDrawProb();
+
+  printf ("AGAINST ENUMERATION.\n");
+
+  SelectStream(2);
+  PutSeed(23);
+
+  for (t = 0; t < 300; t++) {
+    memset(&P, 0, sizeof(P));
+    n = floor(Random() * 8);
+    for (i = 0; i < n; i++)
+      P.deck[curse + (int) floor(Random() * 8)]++;
+    n = floor(Random() * 8);
+    for (i = 0; i < n; i++)
+      P.discard[curse + (int) floor(Random() * 8)]++;
+    checkExact(&P, floor(Random() * 16), curse + floor(Random() * 8));
+  }
+
+  //treasure from addCard is worth its own coins
+  mix[5] = platinum;
+  for (t = 0; t < 300; t++) {
+    memset(&P, 0, sizeof(P));
+    n = floor(Random() * 8);
+    for (i = 0; i < n; i++)
+      P.deck[mix[(int) floor(Random() * 6)]]++;
+    n = floor(Random() * 8);
+    for (i = 0; i < n; i++)
+      P.discard[mix[(int) floor(Random() * 6)]]++;
+    checkExact(&P, floor(Random() * 16), mix[(int) floor(Random() * 6)]);
+  }
+  memset(&P, 0, sizeof(P));
+  P.deck[platinum] = 2;
+  P.deck[copper] = 3;
+  assert(probCoinsAtLeast(&P, 2, 10) > 0.09 && probCoinsAtLeast(&P, 2, 11) == 0);
+
+  //the whole distribution adds up, and the last entry collects the rest
+  initializeGame(2, k, 1, &G);
+  assert(drawPilesOf(0, &G, 1, &P) == 0);
+  assert(coinDistribution(&P, 5, dist, 6) == 0);
+  for (i = 0, total = 0; i < 6; i++)
+    total += dist[i];
+  assert(fabs(total - 1) < 1e-12);
+  assert(fabs(dist[5] - probCoinsAtLeast(&P, 5, 5)) < 1e-12);
+  assert(probCoinsAtLeast(&P, 5, 0) == 1);
+  assert(probCoinsAtLeast(&P, 5, 6) == 0);
+  assert(coinDistribution(&P, -1, dist, 6) == -1);
+  assert(drawPilesOf(2, &G, 0, &P) == -1);
+
+  printf ("AGAINST DRAWCARD.\n");
+
+  //play some turns in, then draw for real many times over
+  for (t = 0; t < 8; t++) {
+    initializeGame(2, k, t + 1, &G);
+    for (i = 0; i < 3 + 2 * t; i++) {
+      buyCard(floor(Random() * 3) + copper, &G);
+      buyCard(smithy, &G);
+      endTurn(&G);
+    }
+    drawPilesOf(whoseTurn(&G), &G, 0, &P);
+    n = 3 + t % 4;
+    coins = 2 + t % 5;
+    card = t % 2 ? silver : estate;
+    p = probCoinsAtLeast(&P, n, coins);
+    q = probCardsAtLeast(&P, n, card, 2);
+
+    hit[0] = hit[1] = 0;
+    for (i = 0; i < TRIALS; i++) {
+      memcpy(&G2, &G, sizeof(struct gameState));
+      SeedStream(&G2.rng, RNG_SPLITMIX, i + 1);
+      shuffle(whoseTurn(&G2), &G2);
+      G2.handCount[whoseTurn(&G2)] = 0;
+      for (j = 0; j < n; j++)
+	drawCard(whoseTurn(&G2), &G2);
+      coins = copies = 0;
+      for (j = 0; j < numHandCards(&G2); j++) {
+	coins += coinsOf(handCard(j, &G2));
+	copies += handCard(j, &G2) == card;
+      }
+      hit[0] += coins >= 2 + t % 5;
+      hit[1] += copies >= 2;
+    }
+    assert(fabs(p - (double) hit[0] / TRIALS) < 0.02);
+    assert(fabs(q - (double) hit[1] / TRIALS) < 0.02);
+  }
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
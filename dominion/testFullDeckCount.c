@@ -0,0 +1,94 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "rngs.h"
+
+#define NOISY_TEST 1
+
+//count the slow way, the way fullDeckCount used to
+int scanCount(int p, int card, struct gameState *G) {
+  int i;
+  int count = 0;
+
+  for (i = 0; i < G->deckCount[p]; i++)
+    if (pileCard(G->deck[p][i], G) == card) count++;
+  for (i = 0; i < G->handCount[p]; i++)
+    if (pileCard(G->hand[p][i], G) == card) count++;
+  for (i = 0; i < G->discardCount[p]; i++)
+    if (pileCard(G->discard[p][i], G) == card) count++;
+
+  return count;
+}
+
+//treasure in hand the way updateCoins used to add it up
+int scanCoins(int p, struct gameState *G) {
+  int i;
+  int coins = 0;
+
+  for (i = 0; i < G->handCount[p]; i++) {
+    if (pileCard(G->hand[p][i], G) == copper) coins += 1;
+    else if (pileCard(G->hand[p][i], G) == silver) coins += 2;
+    else if (pileCard(G->hand[p][i], G) == gold) coins += 3;
+  }
+
+  return coins;
+}
+
+void checkCounts(struct gameState *G) {
+  int p, card;
+
+  for (p = 0; p < G->numPlayers; p++) {
+    for (card = curse; card <= treasure_map; card++) {
+      assert(fullDeckCount(p, card, G) == scanCount(p, card, G));
+    }
+    assert(G->handCoins[p] == scanCoins(p, G));
+  }
+}
+
+int main () {
+
+  int n, step, r;
+
+  //kingdom avoids the cards whose effects can loop forever
+  int k[10] = {council_room, gardens, mine, remodel, smithy, village,
+	       great_hall, steward, cutpurse, salvager};
+
+  struct gameState G;
+
+  printf ("Testing fullDeckCount.\n");
+
+  printf ("RANDOM GAMES.\n");
+
+  SelectStream(2);
+  PutSeed(5);
+
+  for (n = 0; n < 200; n++) {
+    r = initializeGame(2 + n % 3, k, n + 1, &G);
+    assert(r == 0);
+    checkCounts(&G);
+
+    for (step = 0; step < 300 && !isGameOver(&G); step++) {
+      switch ((int) floor(Random() * 3)) {
+      case 0:
+	if (numHandCards(&G) > 0)
+	  playCard(floor(Random() * numHandCards(&G)), floor(Random() * 3),
+		   floor(Random() * (treasure_map + 1)), floor(Random() * 3), &G);
+	break;
+      case 1:
+	buyCard(floor(Random() * (treasure_map + 1)), &G);
+	break;
+      default:
+	endTurn(&G);
+      }
+      checkCounts(&G);
+    }
+  }
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "rngs.h"
+
+//the incremental hash and empty pile count must match ones built from
+//scratch
+void checkHash(struct gameState *G) {
+  struct gameState G2;
+
+  memcpy(&G2, G, sizeof(struct gameState));
+  rehashGameState(&G2);
+  assert(hashGameState(G) == hashGameState(&G2));
+  assert(G->emptyPiles == G2.emptyPiles);
+}
+
+int main () {
+
+  int n, step, r;
+  unsigned long long before;
+
+  //kingdoms avoid the cards whose effects can loop forever or run off
+  //the piles
+  int k[2][10] = {{council_room, gardens, mine, remodel, smithy, village,
+		   great_hall, steward, cutpurse, salvager},
+		  {baron, minion, tribute, ambassador, embargo, outpost,
+		   treasure_map, smithy, village, gardens}};
+
+  struct gameState G;
+
+  printf ("Testing hashGameState.\n");
+
+  printf ("RANDOM GAMES.\n");
+
+  SelectStream(2);
+  PutSeed(9);
+
+  for (n = 0; n < 200; n++) {
+    r = initializeGame(2 + n % 3, k[n % 2], n + 1, &G);
+    assert(r == 0);
+    checkHash(&G);
+
+    for (step = 0; step < 300 && !isGameOver(&G); step++) {
+      switch ((int) floor(Random() * 3)) {
+      case 0:
+	if (numHandCards(&G) > 0)
+	  playCard(floor(Random() * numHandCards(&G)), floor(Random() * 3),
+		   floor(Random() * (treasure_map + 1)), floor(Random() * 3), &G);
+	break;
+      case 1:
+	before = hashGameState(&G);
+	if (buyCard(floor(Random() * (treasure_map + 1)), &G) == 0)
+	  assert(hashGameState(&G) != before);
+	break;
+      default:
+	endTurn(&G);
+      }
+      checkHash(&G);
+    }
+  }
+
+  printf ("ORDER DOES NOT MATTER.\n");
+
+  //shuffling a deck leaves the position, and so the hash, unchanged
+  initializeGame(2, k[0], 3, &G);
+  before = hashGameState(&G);
+  shuffle(1, &G);
+  assert(hashGameState(&G) == before);
+
+  //the same cards in another pile are another position
+  G.discard[1][G.discardCount[1]++] = G.deck[1][--G.deckCount[1]];
+  recountCards(1, &G);
+  assert(hashGameState(&G) != before);
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
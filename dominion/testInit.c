@@ -20,7 +20,7 @@ int main (int argc, char** argv) {
   
   printf ("Rough guide to locations in structure:\n");
   printf ("0: numPlayers\n");
-  printf ("%ld: supplyCount[0]\n", ((long)&(G.supplyCount[0]))-((long)&G));
+  printf ("%ld: pileCount[0]\n", ((long)&(G.pileCount[0]))-((long)&G));
   printf ("%ld: embargoTokens[0]\n", ((long)&(G.embargoTokens[0]))-((long)&G));
   printf ("%ld: hand[0][0]\n", ((long)&(G.hand[0][0]))-(long)(&G));
   printf ("%ld: deck[0][0]\n", ((long)&(G.deck[0][0]))-(long)(&G));
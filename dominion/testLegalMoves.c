@@ -0,0 +1,140 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "moves.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "rngs.h"
+
+static struct move moves[MAX_MOVES];
+
+//piles still inside their arrays
+void checkPiles(struct gameState *G) {
+  int p;
+
+  for (p = 0; p < G->numPlayers; p++) {
+    assert(G->handCount[p] >= 0 && G->handCount[p] <= MAX_HAND);
+    assert(G->deckCount[p] >= 0 && G->deckCount[p] <= MAX_DECK);
+    assert(G->discardCount[p] >= 0 && G->discardCount[p] <= MAX_DECK);
+  }
+  assert(G->playedCardCount >= 0 && G->playedCardCount <= MAX_DECK);
+}
+
+//ten different kingdom cards
+void randomKingdom(int k[10]) {
+  int i, j, used;
+
+  for (i = 0; i < 10; ) {
+    k[i] = adventurer + floor(Random() * (treasure_map - adventurer + 1));
+    used = 0;
+    for (j = 0; j < i; j++)
+      if (k[j] == k[i]) used = 1;
+    if (!used) i++;
+  }
+}
+
+//a Steward or Salvager play that names the card itself as one to trash;
+//playCard takes these, but they are not real choices and are not listed
+int trashesItself(int card, int pos, int choice1, int choice2, int choice3) {
+  if (card == steward)
+    return choice1 != 1 && choice1 != 2 && (choice2 == pos || choice3 == pos);
+  if (card == salvager)
+    return choice1 == pos;
+  return 0;
+}
+
+int main () {
+
+  int g, step, n, i, card, listed;
+  int k[10];
+
+  struct gameState G, before, after;
+
+  printf ("Testing legalMoves.\n");
+
+  printf ("RANDOM GAMES.\n");
+
+  SelectStream(2);
+  PutSeed(13);
+
+  for (g = 0; g < 60; g++) {
+    randomKingdom(k);
+    assert(initializeGame(2 + g % 3, k, g + 1, &G) == 0);
+
+    for (step = 0; step < 300 && !isGameOver(&G); step++) {
+      memcpy(&before, &G, sizeof(struct gameState));
+      n = legalMoves(&G, moves, MAX_MOVES);
+      assert(n >= 1 && n <= MAX_MOVES);
+      assert(memcmp(&before, &G, sizeof(struct gameState)) == 0);
+      assert(moves[n-1].type == MOVE_END);
+
+      //every move listed goes through and leaves the piles in shape
+      for (i = 0; i < n; i++) {
+	memcpy(&after, &G, sizeof(struct gameState));
+	assert(makeMove(&moves[i], &after) == 0);
+	checkPiles(&after);
+      }
+
+      //and every buy that goes through is listed
+      for (card = curse; card <= treasure_map; card++) {
+	listed = 0;
+	for (i = 0; i < n; i++)
+	  if (moves[i].type == MOVE_BUY && moves[i].card == card) listed = 1;
+	memcpy(&after, &G, sizeof(struct gameState));
+	assert((buyCard(card, &after) == 0) == listed);
+      }
+
+      //a short buffer still gets the full count
+      assert(legalMoves(&G, moves, 1) == n);
+
+      makeMove(&moves[(int) floor(Random() * n)], &G);
+    }
+  }
+
+  //Steward and Salvager both trash from hand; with both in hand, every
+  //play that goes through, other than a card trashing itself, must still
+  //be listed.  Copies of a move may be left out, so a play counts as
+  //listed if a listed move ends in the same position
+  printf ("STEWARD AND SALVAGER.\n");
+
+  {
+    int kingdom[10] = {steward, salvager, sea_hag, smithy, village,
+		       baron, great_hall, minion, cutpurse, embargo};
+    int cards[6] = {steward, salvager, sea_hag, copper, estate, sea_hag};
+    int pos, c1, c2, c3;
+    unsigned long long hashes[MAX_MOVES];
+
+    assert(initializeGame(2, kingdom, 1, &G) == 0);
+    for (i = 0; i < 6; i++)
+      G.hand[0][i] = supplyPile(cards[i], &G);
+    G.handCount[0] = 6;
+    recountCards(0, &G);
+
+    n = legalMoves(&G, moves, MAX_MOVES);
+    for (i = 0; i < n; i++) {
+      memcpy(&after, &G, sizeof(struct gameState));
+      assert(makeMove(&moves[i], &after) == 0);
+      hashes[i] = hashGameState(&after);
+    }
+
+    for (pos = 0; pos < 6; pos++)
+      for (c1 = 0; c1 < 6; c1++)
+	for (c2 = 0; c2 < 6; c2++)
+	  for (c3 = 0; c3 < 6; c3++) {
+	    memcpy(&after, &G, sizeof(struct gameState));
+	    if (trashesItself(handCard(pos, &G), pos, c1, c2, c3) ||
+		playCard(pos, c1, c2, c3, &after) != 0)
+	      continue;
+	    listed = 0;
+	    for (i = 0; i < n; i++)
+	      if (hashes[i] == hashGameState(&after)) listed = 1;
+	    assert(listed);
+	  }
+  }
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
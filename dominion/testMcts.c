@@ -0,0 +1,125 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "moves.h"
+#include "strategy.h"
+#include "mcts.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "rngs.h"
+
+static struct move moves[MAX_MOVES];
+
+//best is one of the moves on offer
+int isListed(struct gameState *G, struct move *best) {
+  int n = legalMoves(G, moves, MAX_MOVES);
+  int i;
+
+  for (i = 0; i < n; i++) {
+    if (memcmp(&moves[i], best, sizeof(struct move)) == 0)
+      return 1;
+  }
+  return 0;
+}
+
+int main () {
+
+  int g, step, n, turns;
+  struct move best, other;
+  struct mctsConfig config;
+  struct strategy quick;
+  struct botMemory mem[2];
+
+  int k[10] = {adventurer, council_room, feast, gardens, mine, remodel,
+	       smithy, village, baron, great_hall};
+
+  struct gameState G, before;
+
+  printf ("Testing mctsChoose.\n");
+
+  mctsDefaults(&config);
+  config.iterations = 200;
+  config.worlds = 4;
+
+  printf ("RANDOM POSITIONS.\n");
+
+  SelectStream(2);
+  PutSeed(17);
+
+  for (g = 0; g < 6; g++) {
+    assert(initializeGame(2 + g % 3, k, g + 1, &G) == 0);
+
+    for (step = 0; step < 40 && !isGameOver(&G); step++) {
+      memcpy(&before, &G, sizeof(struct gameState));
+      config.seed = step + 1;
+      config.rollout = (step % 2) ? NULL : "bigmoney";
+      assert(mctsChoose(&G, &config, &best) == 0);
+      assert(memcmp(&before, &G, sizeof(struct gameState)) == 0);
+      assert(isListed(&G, &best));
+
+      //root parallel trees add up to the same answer on any thread count
+      config.threads = 3;
+      assert(mctsChoose(&G, &config, &other) == 0);
+      assert(memcmp(&best, &other, sizeof(struct move)) == 0);
+      config.threads = 1;
+
+      n = legalMoves(&G, moves, MAX_MOVES);
+      makeMove(&moves[(int) floor(Random() * n)], &G);
+    }
+  }
+
+  printf ("OBVIOUS MOVE.\n");
+
+  //taking the last Province ends the game in front
+  initializeGame(2, k, 5, &G);
+  G.pileCount[supplyPile(province, &G)] = 1;
+  G.coins = 8;
+  config.rollout = "bigmoney";
+  assert(mctsChoose(&G, &config, &best) == 0);
+  assert(best.type == MOVE_BUY && best.card == province);
+
+  //a time budget alone is enough
+  config.iterations = 0;
+  config.seconds = 0.05;
+  assert(mctsChoose(&G, &config, &best) == 0);
+  assert(best.type == MOVE_BUY && best.card == province);
+
+  //no budget, no search
+  config.seconds = 0;
+  assert(mctsChoose(&G, &config, &best) == -1);
+  config.iterations = 200;
+  config.rollout = "nobody";
+  assert(mctsChoose(&G, &config, &best) == -1);
+
+  printf ("WHOLE GAME.\n");
+
+  //a copy of the strategy searches with its own config
+  mctsDefaults(&config);
+  config.iterations = 40;
+  config.worlds = 2;
+  quick = mctsStrategy;
+  quick.name = "quick mcts";
+  quick.config = &config;
+  assert(registerStrategy(&quick) >= 0);
+  initializeGame(2, k, 3, &G);
+  memset(mem, 0, sizeof(mem));
+  for (turns = 0; turns < 200 && !isGameOver(&G); turns++)
+    playStrategyTurn(findStrategy(whoseTurn(&G) == 0 ? "quick mcts" : "bigmoney"),
+		     &mem[whoseTurn(&G)], &G, NULL);
+  assert(isGameOver(&G));
+
+  //and plays it the same way every time; how well it plays is for
+  //testMctsStrength (make strength), which takes far longer
+  initializeGame(2, k, 3, &before);
+  memset(mem, 0, sizeof(mem));
+  for (turns = 0; turns < 200 && !isGameOver(&before); turns++)
+    playStrategyTurn(findStrategy(whoseTurn(&before) == 0 ? "quick mcts" : "bigmoney"),
+		     &mem[whoseTurn(&before)], &before, NULL);
+  assert(memcmp(&G, &before, sizeof(struct gameState)) == 0);
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
@@ -0,0 +1,52 @@
+#include "dominion.h"
+#include "strategy.h"
+#include "mcts.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "rngs.h"
+
+//How strong the search bot is, not whether it works (testMcts does
+//that): a few dozen whole games at the default budget, so it is slow
+//and left out of runtests.  Run it with make strength after changing
+//the search or its defaults
+int main () {
+
+  int g, turns, seat, wins, losses;
+  int winners[MAX_PLAYERS];
+  struct botMemory mem[2];
+
+  //simulate's kingdom
+  int k[10] = {adventurer, gardens, embargo, village, minion, mine,
+	       cutpurse, sea_hag, tribute, smithy};
+
+  struct gameState G;
+
+  printf ("Testing mcts against bigmoney.\n");
+
+  //at the default budget the bot wins at least 13 of these 20 games
+  //and twice as many as bigmoney does, playing from both seats
+  assert(registerStrategy(&mctsStrategy) >= 0);
+  wins = losses = 0;
+  for (g = 1; g <= 10; g++) {
+    for (seat = 0; seat < 2; seat++) {
+      initializeGame(2, k, g, &G);
+      memset(mem, 0, sizeof(mem));
+      for (turns = 0; turns < 1000 && !isGameOver(&G); turns++)
+	playStrategyTurn(findStrategy(whoseTurn(&G) == seat ? "mcts" : "bigmoney"),
+			 &mem[whoseTurn(&G)], &G, NULL);
+      getWinners(winners, &G);
+      if (winners[seat] && !winners[1 - seat])
+	wins++;
+      else if (!winners[seat])
+	losses++;
+    }
+  }
+  printf ("mcts won %d and lost %d of 20 games against bigmoney\n", wins, losses);
+  assert(wins >= 13 && wins >= 2 * losses);
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+#include "rngs.h"
+
+#define NOISY_TEST 1
+
+//pile slots holding cards
+void setPile(card_t *pile, int *cards, int n, struct gameState *G) {
+  int i;
+
+  for (i = 0; i < n; i++)
+    pile[i] = supplyPile(cards[i], G);
+}
+
+//replace player p's piles with the given cards and rebuild the counts
+void setPiles(int p, struct gameState *G,
+	      int *deck, int deckCount, int *hand, int handCount,
+	      int *discard, int discardCount) {
+  setPile(G->deck[p], deck, deckCount, G);
+  G->deckCount[p] = deckCount;
+  setPile(G->hand[p], hand, handCount, G);
+  G->handCount[p] = handCount;
+  setPile(G->discard[p], discard, discardCount, G);
+  G->discardCount[p] = discardCount;
+  recountCards(p, G);
+}
+
+int main () {
+
+  int r;
+  int winners[MAX_PLAYERS];
+
+  int k[10] = {adventurer, council_room, feast, gardens, mine,
+	       remodel, smithy, village, baron, great_hall};
+
+  int deck[] = {province, duchy, copper, copper, gardens};
+  int hand[] = {estate, curse, great_hall};
+  int discard[] = {copper, copper, silver, gold, province};
+
+  struct gameState G;
+
+  printf ("Testing scoreFor.\n");
+
+  r = initializeGame(2, k, 1, &G);
+  assert(r == 0);
+
+  //starting deck is 3 estates and 7 coppers
+  assert(scoreFor(0, &G) == 3);
+  assert(scoreFor(1, &G) == 3);
+  assert(scoreFor(2, &G) == -9999);
+
+  //6 + 3 + 1 - 1 + 1 + 6 = 16, plus one Gardens with 13 cards
+  setPiles(0, &G, deck, 5, hand, 3, discard, 5);
+  r = scoreFor(0, &G);
+  printf ("scoreFor(0, &G) = %d, expected 17\n", r);
+  assert(r == 17);
+
+  //gaining a card moves the score without a rescan
+  gainCard(duchy, &G, 0, 0);
+  assert(scoreFor(0, &G) == 20);
+  gainCard(curse, &G, 1, 1);
+  assert(scoreFor(1, &G) == 2);
+
+  //trashing a Great Hall from hand costs its point
+  discardCard(2, 0, &G, 1);
+  assert(scoreFor(0, &G) == 19);
+
+  getWinners(winners, &G);
+  assert(winners[0] == 1 && winners[1] == 0);
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
@@ -1,27 +1,195 @@
 #include "dominion.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <math.h>
+#include "rngs.h"
 
-int compare(const int* a, const int* b);
+int compare(const void* a, const void* b);
 
-int main () {
-  struct gameState G;
+//shuffle must only reorder: same cards, nothing else in the state moves
+void checkShuffle(int p, struct gameState *G) {
   struct gameState G2;
 
-  // Initialize G.
+  memcpy (&G2, G, sizeof(struct gameState));
 
-  memcpy (&G2, &G, sizeof(struct gameState));
+  int ret = shuffle(p,G);
 
-  int ret = shuffle(0,&G);
-
-  if (G.deckCount[0] > 0) {
+  if (G->deckCount[p] > 0) {
     assert (ret != -1);
     
-    qsort ((void*)(G.deck[0]), G.deckCount[0], sizeof(int), compare);
-    qsort ((void*)(G2.deck[0]), G2.deckCount[0], sizeof(int), compare);    
+    qsort ((void*)(G->deck[p]), G->deckCount[p], sizeof(card_t), compare);
+    qsort ((void*)(G2.deck[p]), G2.deckCount[p], sizeof(card_t), compare);    
   } else
     assert (ret == -1);
 
-  assert(memcmp(&G, &G2, sizeof(struct gameState)) == 0);  
+  //the only other change is the game's random streams moving on
+  G2.rng = G->rng;
+  G2.deckRng[p] = G->deckRng[p];
+  assert(memcmp(G, &G2, sizeof(struct gameState)) == 0);  
+}
+
+//what shuffle does outside legacy games, written the plain way: sort
+//the deck by counting each pile, then shuffle the sorted cards with
+//Fisher-Yates, drawing from rng for every card after the first
+void referenceShuffle(card_t *deck, int n, rngStream *rng) {
+  int counts[MAX_SUPPLY];
+  card_t sorted[MAX_DECK];
+  card_t shuffled[MAX_DECK];
+  int i, j, pile;
+
+  memset(counts, 0, sizeof(counts));
+  for (i = 0; i < n; i++)
+    counts[deck[i]]++;
+  for (pile = 0, i = 0; pile < MAX_SUPPLY; pile++) {
+    for (j = 0; j < counts[pile]; j++)
+      sorted[i++] = pile;
+  }
+
+  //inside out: card i goes to a random place at or below i, and the
+  //card that was there moves up to i
+  for (i = 0; i < n; i++) {
+    j = (i == 0) ? 0 : RandomBelow(rng, i + 1);
+    shuffled[i] = shuffled[j];
+    shuffled[j] = sorted[i];
+  }
+  memcpy(deck, shuffled, n * sizeof(card_t));
+}
+
+int main () {
+  struct gameState G;
+  int i, p;
+
+  int k[10] = {adventurer, council_room, feast, gardens, mine,
+	       remodel, smithy, village, baron, great_hall};
+
+  //card order produced by the original shuffle for seed 7
+  card_t legacy[30] = {1, 26, 6, 14, 7, 19, 2, 0, 9, 1, 16, 24, 3, 17, 21,
+		       12, 22, 20, 2, 15, 5, 0, 8, 25, 11, 13, 18, 10, 23, 4};
+
+  printf ("Testing shuffle.\n");
+
+  for (i = 1; i <= 20; i++) {
+    initializeGameOpts(2 + i % 3, k, i, (i % 2 ? GAME_LEGACY_SHUFFLE : 0) |
+		       (i % 4 < 2 ? GAME_FAST_RNG : 0) | (i % 5 < 2 ? GAME_CRN : 0), &G);
+    for (p = 0; p < G.numPlayers; p++) {
+      checkShuffle(p, &G);
+    }
+    G.deckCount[0] = 0;
+    checkShuffle(0, &G);
+  }
+
+  //otherwise the order is pinned to the reference, from one card up to
+  //a full deck, on both engines and on the players' own streams
+  for (i = 0; i < 200; i++) {
+    card_t expected[MAX_DECK];
+    rngStream stream;
+    rngStream *rng;
+    int n, j;
+
+    initializeGameOpts(2 + i % 3, k, i + 1, (i % 2 ? GAME_FAST_RNG : 0) |
+		       (i % 4 < 2 ? GAME_CRN : 0), &G);
+    p = i % G.numPlayers;
+    n = (i % 10 == 0) ? MAX_DECK : 1 + floor(Random() * MAX_DECK);
+    for (j = 0; j < n; j++)
+      G.deck[p][j] = floor(Random() * G.numPiles);
+    G.deckCount[p] = n;
+
+    rng = (G.options & GAME_CRN) ? &G.deckRng[p] : &G.rng;
+    memcpy(expected, G.deck[p], n * sizeof(card_t));
+    stream = *rng;
+    referenceShuffle(expected, n, &stream);
+
+    assert(shuffle(p, &G) == 0);
+    assert(memcmp(G.deck[p], expected, n * sizeof(card_t)) == 0);
+    assert(memcmp(rng, &stream, sizeof(rngStream)) == 0);
+  }
+
+  //legacy mode reproduces old seeds card for card
+  initializeGameOpts(2, k, 7, GAME_LEGACY_SHUFFLE, &G);
+  G.deckCount[0] = 0;
+  for (i = 0; i < 30; i++) {
+    G.deck[0][G.deckCount[0]++] = i % 27;
+  }
+  shuffle(0, &G);
+  assert(memcmp(G.deck[0], legacy, sizeof(legacy)) == 0);
+
+  //a corrupt pile count or deck count must not take shuffle past its
+  //buffers; the cards are still only reordered
+  for (i = 0; i < 4; i++) {
+    initializeGameOpts(2, k, i + 1, i % 2 ? GAME_LEGACY_SHUFFLE : 0, &G);
+    G.numPiles = i < 2 ? 127 : -3;
+    G.deckCount[0] = MAX_DECK;
+    for (p = 0; p < MAX_DECK; p++)
+      G.deck[0][p] = p % 127;
+    checkShuffle(0, &G);
+    G.deckCount[0] = MAX_DECK + 1;
+    assert(shuffle(0, &G) == -1);
+  }
+
+  //bounded draws stay in range on both engines
+  {
+    rngStream r;
+    int n, v;
+    SeedStream(&r, RNG_SPLITMIX, 12345);
+    for (n = 1; n < 1000; n++) {
+      v = RandomBelow(&r, n);
+      assert(v >= 0 && v < n);
+    }
+    SeedStream(&r, RNG_LEHMER, 12345);
+    for (n = 1; n < 1000; n++) {
+      v = RandomBelow(&r, n);
+      assert(v >= 0 && v < n);
+    }
+
+    //this state makes SplitMix return 0, and a 0 must not come out
+    r.engine = RNG_SPLITMIX;
+    r.x = 0x61C8864680B583EBULL;
+    assert(RandomStream(&r) > 0.0);
+    for (n = 0; n < 1000; n++) {
+      double d = RandomStream(&r);
+      assert(d > 0.0 && d < 1.0);
+    }
+  }
+
+  //games keep their own random streams, so interleaving them changes nothing
+  {
+    struct gameState A, B;
+    initializeGame(2, k, 3, &A);
+    initializeGame(2, k, 3, &B);
+    SelectStream(1);
+    PutSeed(99);
+    for (i = 0; i < 10; i++) {
+      shuffle(0, &A);
+      Random();
+      initializeGame(3, k, 4, &G);
+      shuffle(0, &B);
+    }
+    assert(memcmp(A.deck[0], B.deck[0], A.deckCount[0] * sizeof(card_t)) == 0);
+  }
+
+  //under GAME_CRN a player's shuffles do not depend on the other
+  //players' shuffles, on either engine
+  for (i = 0; i < 2; i++) {
+    struct gameState A, B;
+    int options = GAME_CRN | (i ? GAME_FAST_RNG : 0);
+    initializeGameOpts(2, k, 5, options, &A);
+    initializeGameOpts(2, k, 5, options, &B);
+    assert(memcmp(A.deck[0], B.deck[0], A.deckCount[0] * sizeof(card_t)) == 0);
+    for (p = 0; p < 10; p++) {
+      shuffle(0, &A);
+      shuffle(1, &B);
+      shuffle(1, &B);
+      shuffle(0, &B);
+      gameRandom(&B);
+    }
+    assert(memcmp(A.deck[0], B.deck[0], A.deckCount[0] * sizeof(card_t)) == 0);
+    assert(memcmp(A.deckRng, B.deckRng, sizeof(rngStream)) == 0);
+    assert(memcmp(&A.deckRng[0], &A.deckRng[1], sizeof(rngStream)) != 0);
+  }
+
+  printf ("ALL TESTS OK\n");
 
+  return 0;
 }
@@ -0,0 +1,119 @@
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "moves.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "rngs.h"
+
+#define KINGDOMS 4
+
+static struct undoLog undo;
+
+//one move for kingdom kind: in the first two kingdoms a random play
+//(often illegal), buy or end turn; the others have cards whose effects
+//loop forever or run off the piles on bad choices, so they pick one of
+//the legal moves
+int randomMove(struct gameState *G, int kind) {
+  struct move moves[MAX_MOVES];
+  int move = floor(Random() * 3);
+  int n;
+
+  if (kind >= 2) {
+    n = legalMoves(G, moves, MAX_MOVES);
+    return makeMove(&moves[(int) floor(Random() * n)], G);
+  }
+  if (move == 0)
+    return playCard(floor(Random() * (numHandCards(G) + 1)), floor(Random() * 3),
+		    floor(Random() * (treasure_map + 1)), floor(Random() * 3), G);
+  if (move == 1)
+    return buyCard(floor(Random() * (treasure_map + 1)), G);
+  return endTurn(G);
+}
+
+int main () {
+
+  int n, step, r, i, kind;
+  long seed;
+
+  int k[KINGDOMS][10] = {{council_room, gardens, mine, remodel, smithy, village,
+			  great_hall, steward, cutpurse, salvager},
+			 {baron, minion, steward, ambassador, embargo, outpost,
+			  treasure_map, smithy, village, gardens},
+			 {adventurer, feast, tribute, sea_hag, smithy, village,
+			  council_room, great_hall, baron, gardens},
+			 {adventurer, feast, tribute, sea_hag, mine, remodel,
+			  minion, cutpurse, outpost, treasure_map}};
+
+  struct gameState G, before, start;
+
+  printf ("Testing undoMove.\n");
+
+  printf ("EACH MOVE.\n");
+
+  SelectStream(2);
+  PutSeed(11);
+
+  //the whole state comes back byte for byte, random streams included
+  for (n = 0; n < 400; n++) {
+    kind = n % KINGDOMS;
+    r = initializeGameOpts(2 + n % 3, k[kind], n + 1, n % 8 < 4 ? 0 : GAME_FAST_RNG | GAME_CRN, &G);
+    assert(r == 0);
+    G.undo = &undo;
+
+    for (step = 0; step < 300 && !isGameOver(&G); step++) {
+      //make the move, take it back, then make it again for real
+      memcpy(&before, &G, sizeof(struct gameState));
+      GetSeed(&seed);
+      r = randomMove(&G, kind);
+      if (r < 0) {
+	//a move that fails changes nothing and leaves no record
+	assert(kind < 2);
+	assert(undo.moves == 0 && undo.used == 0);
+	assert(memcmp(&before, &G, sizeof(struct gameState)) == 0);
+	continue;
+      }
+      assert(undo.moves == 1);
+      assert(undoMove(&G) == 0);
+      assert(undo.moves == 0 && undo.used == 0);
+      assert(memcmp(&before, &G, sizeof(struct gameState)) == 0);
+
+      PutSeed(seed);
+      assert(randomMove(&G, kind) == 0);
+      undo.moves = 0;
+      undo.used = 0;
+    }
+  }
+
+  printf ("WHOLE GAMES.\n");
+
+  //a line of moves unwinds back to the start, however long the log gets
+  for (n = 0; n < 100; n++) {
+    kind = n % KINGDOMS;
+    initializeGameOpts(2 + n % 3, k[kind], n + 1, n % 8 < 4 ? 0 : GAME_FAST_RNG | GAME_CRN, &G);
+    G.undo = &undo;
+    memcpy(&start, &G, sizeof(struct gameState));
+
+    for (step = 0; step < 400 && !isGameOver(&G); step++)
+      randomMove(&G, kind);
+
+    assert(!undo.overflow && undo.used <= undo.size);
+    for (i = undo.moves; i > 0; i--)
+      assert(undoMove(&G) == 0);
+    assert(undoMove(&G) == -1);
+    assert(undo.used == 0);
+    assert(memcmp(&start, &G, sizeof(struct gameState)) == 0);
+  }
+  freeUndoLog(&undo);
+  assert(undo.buf == NULL && undo.size == 0);
+
+  //no log, nothing to undo
+  initializeGame(2, k[0], 1, &G);
+  assert(undoMove(&G) == -1);
+
+  printf ("ALL TESTS OK\n");
+
+  return 0;
+}
@@ -0,0 +1,284 @@
+/* Round-robin tournament between every registered strategy
+
+   Each pairing plays games two at a time on the same seed, once from
+   each seat, with the kingdom picked by selectKingdom from that
+   seed.  A game scores 1 for a win, 1/2 for a tie and 0 for a loss.
+   After every batch the pairing stops once its score is clearly away
+   from 1/2, or when it reaches maxGames.
+
+   ./tournament <maxGames> <threads> [fast] [legacy] [crn] [mcts]
+                [pool=<file>] [kingdom=<n>]
+
+   mcts enters the search bot as well, which makes the run far slower.
+   pool adds the cards listed in file (see loadCardPool) to the ones
+   kingdoms are picked from, and kingdom sets how many kingdom piles a
+   game has, 10 by default.  Any other argument prints the usage.
+*/
+
+#include "dominion.h"
+#include "dominion_helpers.h"
+#include "interface.h"
+#include "strategy.h"
+#include "mcts.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+
+//games still going after this many turns are counted as unfinished
+#define MAX_TURNS 1000
+
+#define MAX_THREADS 256
+
+//game g plays on seed g/2+1, and seeds past this repeat or read stdin
+#define MAX_SEED (INT_MAX - 1)
+#define MAX_GAMES (2L * MAX_SEED)
+
+//games played between two looks at the score, keep it even
+#define BATCH 1000
+
+//95% interval for the report.  The stop test looks after every batch,
+//so it asks for a wider margin to keep false calls rare
+#define Z_REPORT 1.96
+#define Z_STOP 3.29
+
+struct tally {
+  long games;
+  long wins[2];          //outright wins for each strategy of the pairing
+  long ties;
+  long unfinished;
+};
+
+struct job {
+  int thread;
+  int numThreads;
+  long firstGame;
+  long lastGame;
+  int options;
+  int kingdom;           //kingdom piles per game
+  const struct strategy *strategy[2];
+  struct tally tally;
+};
+
+//game g is seed g/2+1, strategy 0 sits first on even games
+static void playGame(long g, struct job *job) {
+  struct gameState G;
+  struct botMemory mem[2];
+  const struct strategy *seat[2];
+  int winners[MAX_PLAYERS];
+  int k[MAX_KINGDOM];
+  int swap = g & 1;
+  int seed = (int) (g / 2 + 1);
+  int turns = 0;
+
+  seat[0] = job->strategy[swap];
+  seat[1] = job->strategy[!swap];
+
+  selectKingdom(seed, k, job->kingdom);
+  memset(mem, 0, sizeof(mem));
+  if (initializeGameSupply(2, k, job->kingdom, seed, job->options, &G) < 0)
+    return;
+
+  while (!isGameOver(&G) && turns < MAX_TURNS) {
+    playStrategyTurn(seat[whoseTurn(&G)], &mem[whoseTurn(&G)], &G, NULL);
+    turns++;
+  }
+
+  job->tally.games++;
+  if (turns >= MAX_TURNS) {
+    job->tally.unfinished++;
+    return;
+  }
+
+  getWinners(winners, &G);
+  if (winners[0] && winners[1])
+    job->tally.ties++;
+  else if (winners[0])
+    job->tally.wins[swap]++;
+  else
+    job->tally.wins[!swap]++;
+}
+
+static void *runJob(void *arg) {
+  struct job *job = arg;
+  long g;
+
+  //threads take games round robin, so the totals do not depend on timing
+  for (g = job->firstGame + job->thread; g <= job->lastGame; g += job->numThreads)
+    playGame(g, job);
+
+  return NULL;
+}
+
+//score of strategy 0 over finished games and the half width of its
+//interval at z, returns -1 if no game finished
+static int scoreOf(const struct tally *t, double z, double *score, double *halfWidth) {
+  long finished = t->games - t->unfinished;
+  double mean, meanSq;
+
+  if (finished <= 0)
+    return -1;
+
+  mean = (t->wins[0] + 0.5 * t->ties) / finished;
+  meanSq = (t->wins[0] + 0.25 * t->ties) / finished;
+  *score = mean;
+  *halfWidth = z * sqrt((meanSq - mean * mean) / finished);
+  return 0;
+}
+
+//play a, b until the score is decided or maxGames are played
+static int playPairing(const struct strategy *a, const struct strategy *b,
+		       long maxGames, int numThreads, int options, int kingdom,
+		       struct tally *total) {
+  struct job jobs[MAX_THREADS];
+  pthread_t threads[MAX_THREADS];
+  double score, halfWidth;
+  long first, last;
+  int i;
+
+  memset(total, 0, sizeof(*total));
+  for (first = 0; first < maxGames; first += BATCH) {
+    last = first + BATCH - 1;
+    if (last >= maxGames)
+      last = maxGames - 1;
+
+    memset(jobs, 0, sizeof(jobs));
+    for (i = 0; i < numThreads; i++) {
+      jobs[i].thread = i;
+      jobs[i].numThreads = numThreads;
+      jobs[i].firstGame = first;
+      jobs[i].lastGame = last;
+      jobs[i].options = options;
+      jobs[i].kingdom = kingdom;
+      jobs[i].strategy[0] = a;
+      jobs[i].strategy[1] = b;
+      if (pthread_create(&threads[i], NULL, runJob, &jobs[i]) != 0) {
+	printf("Could not start thread %d\n", i);
+	return -1;
+      }
+    }
+
+    for (i = 0; i < numThreads; i++) {
+      pthread_join(threads[i], NULL);
+      total->games += jobs[i].tally.games;
+      total->wins[0] += jobs[i].tally.wins[0];
+      total->wins[1] += jobs[i].tally.wins[1];
+      total->ties += jobs[i].tally.ties;
+      total->unfinished += jobs[i].tally.unfinished;
+    }
+
+    if (scoreOf(total, Z_STOP, &score, &halfWidth) == 0 &&
+	fabs(score - 0.5) > halfWidth)
+      return 1;
+  }
+
+  return 0;
+}
+
+static int usage(void) {
+  printf("Usage: tournament <maxGames> <threads> [fast] [legacy] [crn] [mcts] "
+	 "[pool=<file>] [kingdom=<n>]\n");
+  return EXIT_FAILURE;
+}
+
+//the whole of s as a number from low to high, or -1 if it is not one
+static int parseNumber(const char *s, long low, long high, long *value) {
+  char *end;
+
+  errno = 0;
+  *value = strtol(s, &end, 10);
+  if (end == s || *end != '\0' || errno != 0 || *value < low || *value > high)
+    return -1;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  struct tally t;
+  double score, halfWidth;
+  double sum[MAX_STRATEGIES];
+  int n;
+  long maxGames, number;
+  int numThreads;
+  int options = 0;
+  int kingdom = NUM_K_CARDS;
+  int decided;
+  int a, b, i;
+
+  if (argc < 3)
+    return usage();
+
+  if (parseNumber(argv[1], 2, MAX_GAMES, &maxGames) < 0) {
+    printf("maxGames must be between 2 and %ld\n", MAX_GAMES);
+    return EXIT_FAILURE;
+  }
+  if (parseNumber(argv[2], 1, MAX_THREADS, &number) < 0) {
+    printf("threads must be between 1 and %d\n", MAX_THREADS);
+    return EXIT_FAILURE;
+  }
+  numThreads = (int) number;
+
+  for (i = 3; i < argc; i++) {
+    if (strcmp(argv[i], "fast") == 0)
+      options |= GAME_FAST_RNG;
+    else if (strcmp(argv[i], "legacy") == 0)
+      options |= GAME_LEGACY_SHUFFLE;
+    else if (strcmp(argv[i], "crn") == 0)
+      options |= GAME_CRN;
+    else if (strcmp(argv[i], "mcts") == 0)
+      registerStrategy(&mctsStrategy);
+    else if (strncmp(argv[i], "pool=", 5) == 0) {
+      if (loadCardPool(argv[i] + 5) < 0) {
+	printf("Could not load the cards in %s\n", argv[i] + 5);
+	return EXIT_FAILURE;
+      }
+    }
+    else if (strncmp(argv[i], "kingdom=", 8) == 0) {
+      if (parseNumber(argv[i] + 8, 0, MAX_KINGDOM, &number) < 0) {
+	printf("kingdom must be between 0 and %d\n", MAX_KINGDOM);
+	return EXIT_FAILURE;
+      }
+      kingdom = (int) number;
+    }
+    else
+      return usage();
+  }
+  if (kingdom > numCards() - adventurer) {
+    printf("kingdom must be between 0 and %d\n",
+	   MAX_KINGDOM < numCards() - adventurer ? MAX_KINGDOM : numCards() - adventurer);
+    return EXIT_FAILURE;
+  }
+  n = numStrategies();
+
+  memset(sum, 0, sizeof(sum));
+  for (a = 0; a < n; a++) {
+    for (b = a + 1; b < n; b++) {
+      decided = playPairing(getStrategy(a), getStrategy(b), maxGames, numThreads, options, kingdom, &t);
+      if (decided < 0)
+	return EXIT_FAILURE;
+
+      printf("%s vs %s: %ld games", getStrategy(a)->name, getStrategy(b)->name, t.games);
+      if (scoreOf(&t, Z_REPORT, &score, &halfWidth) < 0) {
+	printf(", none finished\n");
+	continue;
+      }
+      printf(", %s scores %.4f +- %.4f (wins %.4f, losses %.4f, ties %.4f, unfinished %.4f)%s\n",
+	     getStrategy(a)->name, score, halfWidth,
+	     (double) t.wins[0] / t.games, (double) t.wins[1] / t.games,
+	     (double) t.ties / t.games, (double) t.unfinished / t.games,
+	     decided ? "" : " undecided");
+      sum[a] += score;
+      sum[b] += 1 - score;
+    }
+  }
+
+  if (n > 1) {
+    printf("average score against the field:\n");
+    for (a = 0; a < n; a++)
+      printf("%-12s %.4f\n", getStrategy(a)->name, sum[a] / (n - 1));
+  }
+
+  return EXIT_SUCCESS;
+}